@@ -0,0 +1,176 @@
+#include <Crystalline.h>
+#include <Panels.h>
+#include <Popups.h>
+#include <Printers.h>
+
+// Renders into a simulated 20x4 HD44780 that counts the traffic a real
+// display would see, so render cost can be compared between releases
+// without a display attached. Results are printed over Serial, or to
+// stdout when built on a desktop with the CMake project at the root of
+// the library.
+
+const int ControlCount = 24;
+
+SimulatedPrinter printer(20, 4);
+
+int value = 0;
+
+int getValue() { return value; }
+
+void setValue(int v) { value = v; }
+
+NumberControl<int> controls[ControlCount];
+
+Array<Control*> controlList() {
+    auto list = Array<Control*>::ofSize(ControlCount, nullptr);
+    for (int i = 0; i < ControlCount; i++)
+        list[i] = &controls[i];
+    return list;
+}
+
+auto panel = ControlPanel("Benchmark", controlList());
+
+auto root = MenuLayout(Array<MenuPanel*> { &panel });
+
+auto popup = WarningPopup("Warning", "Benchmark");
+
+void press(KeyCode key) {
+    Crystalline::interact(Interaction(key, KeyState::Down));
+    Crystalline::interact(Interaction(key, KeyState::Up));
+    Crystalline::update();
+}
+
+void fullRedraw() {
+    printer.invalidate();
+    Crystalline::invalidateView();
+    Crystalline::update();
+}
+
+void unchangedRedraw() {
+    Crystalline::invalidateView();
+    Crystalline::update();
+}
+
+void idleFrames() {
+    for (int i = 0; i < 100; i++)
+        Crystalline::update();
+}
+
+void valueChanges() {
+    for (int i = 0; i < 100; i++) {
+        value++;
+        Crystalline::update();
+    }
+}
+
+void scrolling() {
+    for (int i = 0; i < ControlCount; i++)
+        press(KeyCode::DownArrow);
+    for (int i = 0; i < ControlCount; i++)
+        press(KeyCode::UpArrow);
+}
+
+void typeText(const char* text) {
+    while (*text)
+        press((KeyCode)*text++);
+}
+
+void jumping() {
+    press(KeyCode::DownArrow);
+    typeText("value 23");
+    typeText("value 0");
+}
+
+void popupShowHide() {
+    for (int i = 0; i < 10; i++) {
+        PopupManager::show(popup);
+        Crystalline::update();
+        PopupManager::hide(popup);
+        Crystalline::update();
+    }
+}
+
+volatile uint8_t formatted;
+
+void stringFormat() {
+    for (int i = 0; i < 1000; i++) {
+        String s = String(i * 0.37f - 150.0f, 1);
+        if (s == "-0.0")
+            s = "0.0";
+        formatted = s.length();
+    }
+}
+
+void bufferFormat() {
+    char buffer[NumberFormat::Capacity];
+    for (int i = 0; i < 1000; i++)
+        formatted = NumberFormatter::format(buffer, i * 0.37f - 150.0f, NumberFormat(1));
+}
+
+Getter<int>* heapGetter = delegateOf(&getValue);
+
+InlineGetter<int> inlineGetter = &getValue;
+
+volatile int called;
+
+void heapDelegate() {
+    for (int i = 0; i < 1000; i++)
+        called = heapGetter->invoke();
+}
+
+void inlineDelegate() {
+    for (int i = 0; i < 1000; i++)
+        called = inlineGetter();
+}
+
+void measure(const char* name, void (*scenario)()) {
+    printer.resetBusStats();
+    uint32_t start = micros();
+    scenario();
+    uint32_t cpu = micros() - start;
+    auto& bus = printer.getBusStats();
+
+    Serial.print(name);
+    Serial.print(F(": cpu="));
+    Serial.print(cpu);
+    Serial.print(F("us bytes="));
+    Serial.print(bus.bytes);
+    Serial.print(F(" commands="));
+    Serial.print(bus.commands);
+    Serial.print(F(" uploads="));
+    Serial.print(bus.uploads);
+    Serial.print(F(" bus="));
+    Serial.print(bus.micros);
+    Serial.println(F("us"));
+}
+
+void setup() {
+    Serial.begin(115200);
+
+    for (int i = 0; i < ControlCount; i++) {
+        controls[i].header = String("Value ") + i;
+        controls[i].content = propertyOf(&getValue, &setValue);
+    }
+
+    Crystalline::begin(&printer, root);
+    Crystalline::update();
+
+    measure("full redraw", fullRedraw);
+    measure("unchanged redraw", unchangedRedraw);
+    measure("idle x100", idleFrames);
+    measure("value change x100", valueChanges);
+    measure("scroll", scrolling);
+    measure("jump", jumping);
+    measure("popup x10", popupShowHide);
+    measure("String format x1000", stringFormat);
+    measure("NumberFormatter x1000", bufferFormat);
+    measure("Delegate x1000", heapDelegate);
+    measure("InlineDelegate x1000", inlineDelegate);
+
+    Serial.print(F("index footprint="));
+    Serial.print(panel.getIndex().getFootprint());
+    Serial.println(F(" bytes"));
+}
+
+void loop() {
+}
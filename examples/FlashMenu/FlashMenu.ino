@@ -0,0 +1,59 @@
+#include <Crystalline.h>
+#include <Tables.h>
+#include <Printers.h>
+
+// A menu described entirely by tables in flash. Only the panel and its
+// pool of row controls live in RAM, however many rows are declared.
+
+SimulatedPrinter printer(20, 4);
+
+int32_t speed = 50;
+int32_t mode = 0;
+int32_t enabled = 1;
+
+int32_t getSpeed() { return speed; }
+void setSpeed(int32_t value) { speed = value; }
+int32_t getMode() { return mode; }
+void setMode(int32_t value) { mode = value; }
+int32_t getEnabled() { return enabled; }
+void setEnabled(int32_t value) { enabled = value; }
+void resetAll() { speed = 50; mode = 0; enabled = 1; }
+
+const char MotorHeader[] PROGMEM = "Motor";
+const char SystemHeader[] PROGMEM = "System";
+const char SpeedHeader[] PROGMEM = "Speed";
+const char SpeedSuffix[] PROGMEM = "%";
+const char ModeHeader[] PROGMEM = "Mode";
+const char AutoOption[] PROGMEM = "Auto";
+const char ManualOption[] PROGMEM = "Manual";
+const char* const ModeOptions[] PROGMEM = { AutoOption, ManualOption };
+const char EnabledHeader[] PROGMEM = "Enabled";
+const char VersionHeader[] PROGMEM = "Version 1.0";
+const char ResetHeader[] PROGMEM = "Reset";
+
+const RowDescriptor MotorRows[] PROGMEM = {
+    numberRow(SpeedHeader, getSpeed, setSpeed, 0, 100, 5, SpeedSuffix),
+    switchRow(ModeHeader, ModeOptions, getMode, setMode),
+    toggleRow(EnabledHeader, getEnabled, setEnabled),
+};
+
+const RowDescriptor SystemRows[] PROGMEM = {
+    labelRow(VersionHeader),
+    buttonRow(ResetHeader, resetAll),
+};
+
+const PanelDescriptor Panels[] PROGMEM = {
+    panelOf(MotorHeader, MotorRows),
+    panelOf(SystemHeader, SystemRows),
+};
+
+auto root = TableMenu(Panels);
+
+void setup() {
+    Serial.begin(9600);
+    Crystalline::begin(&printer, root);
+}
+
+void loop() {
+    Crystalline::update();
+}
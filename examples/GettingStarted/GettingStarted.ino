@@ -5,7 +5,8 @@ class CrystalPrinter : public PrinterBase {
 public:
     LiquidCrystal& lcd;
     
-    CrystalPrinter(LiquidCrystal& lcd, int width, int height) : PrinterBase(width, height), lcd(lcd) {
+    // setCursor is a single command byte, so it costs as much as printing one character.
+    CrystalPrinter(LiquidCrystal& lcd, int width, int height) : PrinterBase(width, height, 1, 1), lcd(lcd) {
         lcd.begin(width, height);
         lcd.clear();
     }
@@ -26,6 +27,11 @@ protected:
         lcd.setCursor(x, y);
         return true;
     }
+
+    virtual bool defineCore(uint8_t slot, const uint8_t* bitmap) override {
+        lcd.createChar(slot, const_cast<uint8_t*>(bitmap));
+        return true;
+    }
 };
 
 struct Source {
@@ -38,15 +44,17 @@ struct Source {
     void action() { n = 0; }
 };
 
+Source source;
+
 auto lcd = LiquidCrystal(2, 3, 4, 5, 6, 7);
 
-auto printer = CrystalPrinter(lcd, 16, 2);
+CrystalPrinter printer(lcd, 16, 2);
 
 auto root = MenuLayout(Array<MenuPanel*> {
     new ControlPanel("Header", Array<Control*> {
-        new NumberControl<int>("Number", "", propertyOf(&Source::getInt)),
-        new SwitchControl("Switch", arrayOf<String>("a", "b", "c"), propertyOf(&Source::getInt, &Source::setInt)),
-        new ButtonControl("click", delegateOf(&Source::action)),
+        new NumberControl<int>("Number", "", propertyOf(source, &Source::getInt)),
+        new SwitchControl("Switch", arrayOf<String>("a", "b", "c"), propertyOf(source, &Source::getInt, &Source::setInt)),
+        new ButtonControl("click", delegateOf(source, &Source::action)),
     })
 });
 
@@ -54,6 +62,6 @@ void setup() {
     Crystalline::begin(&printer, root);
 }
 
-void update() {
+void loop() {
     Crystalline::update();
 }
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <time.h>
+#include "Arduino.h"
+
+HardwareSerial Serial;
+
+static uint64_t monotonicMicros()
+{
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return uint64_t(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+static const uint64_t start = monotonicMicros();
+
+unsigned long millis()
+{
+	return (monotonicMicros() - start) / 1000;
+}
+
+unsigned long micros()
+{
+	return monotonicMicros() - start;
+}
+
+void delay(unsigned long ms)
+{
+	timespec duration = { time_t(ms / 1000), long(ms % 1000) * 1000000 };
+	nanosleep(&duration, nullptr);
+}
+
+#pragma region String
+
+static std::string formatInteger(unsigned long magnitude, bool negative, unsigned char base)
+{
+	char digits[sizeof(unsigned long) * 8 + 2];
+	auto i = sizeof(digits);
+	digits[--i] = '\0';
+	do
+	{
+		auto digit = magnitude % base;
+		digits[--i] = digit < 10 ? '0' + digit : 'A' + digit - 10;
+		magnitude /= base;
+	} while (magnitude > 0);
+	if (negative)
+		digits[--i] = '-';
+	return std::string(digits + i);
+}
+
+static std::string formatFloat(double value, unsigned char decimals)
+{
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+	return buffer;
+}
+
+String::String(int value, unsigned char base) : String(long(value), base) { }
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) { }
+String::String(long value, unsigned char base) :
+	_value(formatInteger(value < 0 && base == DEC ? 0UL - (unsigned long)value : (unsigned long)value, value < 0 && base == DEC, base)) { }
+String::String(unsigned long value, unsigned char base) : _value(formatInteger(value, false, base)) { }
+String::String(float value, unsigned char decimals) : _value(formatFloat(value, decimals)) { }
+String::String(double value, unsigned char decimals) : _value(formatFloat(value, decimals)) { }
+
+#pragma endregion
+
+#pragma region HardwareSerial
+
+size_t HardwareSerial::print(const char* s)
+{
+	return fputs(s, stdout) >= 0 ? strlen(s) : 0;
+}
+
+size_t HardwareSerial::print(char c)
+{
+	return putchar(c) != EOF ? 1 : 0;
+}
+
+size_t HardwareSerial::print(long value, int base)
+{
+	return print(String(value, base));
+}
+
+size_t HardwareSerial::print(unsigned long value, int base)
+{
+	return print(String(value, base));
+}
+
+size_t HardwareSerial::print(double value, int digits)
+{
+	return print(String(value, digits));
+}
+
+#pragma endregion
@@ -0,0 +1,100 @@
+#pragma once
+
+// Minimal stand-in for the Arduino core, enough to build the library and
+// its example sketches on a desktop compiler. Flash is ordinary memory
+// here, and timing comes from the monotonic system clock.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <string>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(PSTR(s)))
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+
+#define DEC 10
+#define HEX 16
+
+class __FlashStringHelper;
+
+inline uint8_t pgm_read_byte(const void* p) { return *static_cast<const uint8_t*>(p); }
+inline uint16_t pgm_read_word(const void* p) { return *static_cast<const uint16_t*>(p); }
+inline uint32_t pgm_read_dword(const void* p) { return *static_cast<const uint32_t*>(p); }
+inline const void* pgm_read_ptr(const void* p) { return *static_cast<const void* const*>(p); }
+inline void* memcpy_P(void* destination, const void* source, size_t size) { return memcpy(destination, source, size); }
+inline size_t strlen_P(const char* s) { return strlen(s); }
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+inline void noInterrupts() { }
+inline void interrupts() { }
+
+class String
+{
+private:
+	std::string _value;
+
+public:
+	String() { }
+	String(const char* s) : _value(s != nullptr ? s : "") { }
+	String(const __FlashStringHelper* s) : String(reinterpret_cast<const char*>(s)) { }
+	explicit String(char c) : _value(1, c) { }
+	explicit String(int value, unsigned char base = DEC);
+	explicit String(unsigned int value, unsigned char base = DEC);
+	explicit String(long value, unsigned char base = DEC);
+	explicit String(unsigned long value, unsigned char base = DEC);
+	explicit String(float value, unsigned char decimals = 2);
+	explicit String(double value, unsigned char decimals = 2);
+
+	unsigned int length() const { return _value.size(); }
+	const char* c_str() const { return _value.c_str(); }
+	char charAt(unsigned int index) const { return index < _value.size() ? _value[index] : 0; }
+	char operator[](unsigned int index) const { return charAt(index); }
+	bool equals(const String& other) const { return _value == other._value; }
+	bool operator==(const String& other) const { return equals(other); }
+	bool operator!=(const String& other) const { return !equals(other); }
+
+	String& concat(const String& other) { _value += other._value; return *this; }
+	String& operator+=(const String& other) { return concat(other); }
+	String& operator+=(const char* other) { return concat(String(other)); }
+	String& operator+=(char c) { _value += c; return *this; }
+	String& operator+=(int value) { return concat(String(value)); }
+	String& operator+=(long value) { return concat(String(value)); }
+
+	template<class T>
+	friend String operator+(String lhs, const T& rhs) { return lhs += rhs; }
+	friend String operator+(const char* lhs, const String& rhs) { return String(lhs) += rhs; }
+};
+
+class HardwareSerial
+{
+public:
+	void begin(unsigned long baud) { }
+
+	size_t print(const char* s);
+	size_t print(const __FlashStringHelper* s) { return print(reinterpret_cast<const char*>(s)); }
+	size_t print(const String& s) { return print(s.c_str()); }
+	size_t print(char c);
+	size_t print(int value, int base = DEC) { return print(long(value), base); }
+	size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+	size_t print(long value, int base = DEC);
+	size_t print(unsigned long value, int base = DEC);
+	size_t print(double value, int digits = 2);
+
+	size_t println() { return print('\n'); }
+	template<class T>
+	size_t println(const T& value) { return print(value) + println(); }
+	template<class T>
+	size_t println(const T& value, int format) { return print(value, format) + println(); }
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Arduino.h"
+
+// Accepts every call and drives nothing, so sketches written for an
+// HD44780 build on the host.
+class LiquidCrystal
+{
+public:
+	LiquidCrystal(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7) { }
+
+	void begin(uint8_t columns, uint8_t rows) { }
+	void clear() { }
+	void setCursor(uint8_t column, uint8_t row) { }
+	void createChar(uint8_t slot, uint8_t* bitmap) { }
+	size_t print(char c) { return 1; }
+};
@@ -0,0 +1,12 @@
+#include "Arduino.h"
+
+void setup();
+void loop();
+
+// Runs a sketch once: setup() followed by a single pass of loop().
+int main()
+{
+	setup();
+	loop();
+	return 0;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdio.h>
+
+// Minimal assertions for the host tests. A failed check is reported and
+// the test goes on, so one run shows every failure; main() returns
+// CHECK_RESULT() for ctest.
+
+static int checkFailures = 0;
+
+#define CHECK(condition) \
+	do { if (!(condition)) { checkFailures++; printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); } } while (0)
+
+#define CHECK_EQUAL(actual, expected) \
+	do { long a = (long)(actual), e = (long)(expected); if (a != e) { checkFailures++; printf("%s:%d: %s is %ld, expected %ld\n", __FILE__, __LINE__, #actual, a, e); } } while (0)
+
+#define CHECK_RESULT() (checkFailures == 0 ? 0 : 1)
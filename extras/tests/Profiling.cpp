@@ -0,0 +1,69 @@
+#include "Crystalline.h"
+#include "Panels.h"
+#include "Printers.h"
+#include "Check.h"
+
+// Built with -DCRYSTALLINE_PROFILING. A queued printer with a short queue
+// makes the first frames flush only part of the display, so the counters
+// of interrupted flushes are checked too.
+
+class ShortQueuePrinter : public QueuedPrinter
+{
+protected:
+	bool sendPrintCore(char c) override { return true; }
+	bool sendMoveCore(uint8_t x, uint8_t y) override { return true; }
+
+public:
+	ShortQueuePrinter() : QueuedPrinter(16, 2, 8) { }
+};
+
+int value = 0;
+
+int getValue() { return value; }
+
+void setValue(int v) { value = v; }
+
+int main()
+{
+	ShortQueuePrinter printer;
+	NumberControl<int> control("Value", "", propertyOf(&getValue, &setValue));
+	ControlPanel panel("Panel", Array<Control*> { &control });
+	MenuLayout root(Array<MenuPanel*> { &panel });
+	UIContext context;
+	CHECK(context.begin(&printer, root));
+
+	// Every cell is unknown at first, so the frames it takes to get the
+	// display out write each cell once between them.
+	uint16_t written = 0;
+	uint8_t frames = 0;
+	bool flushed = false;
+	while (!flushed && frames < 20)
+	{
+		flushed = context.update();
+		written += context.getLastFrame().written;
+		CHECK(flushed || context.getLastFrame().written > 0);
+		printer.pump(255);
+		frames++;
+	}
+	CHECK(flushed);
+	CHECK(frames > 1);
+	CHECK_EQUAL(written, 32);
+
+	context.update();
+	auto& idle = context.getLastFrame();
+	CHECK_EQUAL(idle.drawn, 0);
+	CHECK_EQUAL(idle.written, 0);
+	CHECK_EQUAL(idle.moves, 0);
+	CHECK(idle.updated > 0);
+
+	// The control is drawn, with the panel and the layout on its path.
+	value = 7;
+	context.update();
+	auto& change = context.getLastFrame();
+	CHECK_EQUAL(change.drawn, 3);
+	CHECK_EQUAL(change.written, 1);
+	CHECK_EQUAL(change.moves, 1);
+	CHECK(context.getFrameHistogram().count() > 0);
+
+	return CHECK_RESULT();
+}
@@ -0,0 +1,88 @@
+#include "Crystalline.h"
+#include "Panels.h"
+#include "Printers.h"
+#include "Check.h"
+
+// Drives a control panel on a simulated 20x4 display and checks what ends
+// up on the glass and what it costs on the bus.
+
+const int ControlCount = 24;
+
+SimulatedPrinter printer(20, 4);
+
+UIContext context;
+
+int value = 0;
+
+int getValue() { return value; }
+
+void setValue(int v) { value = v; }
+
+void press(KeyCode key)
+{
+	context.interact(Interaction(key, KeyState::Down));
+	context.interact(Interaction(key, KeyState::Up));
+	context.update();
+}
+
+void typeText(const char* text)
+{
+	while (*text)
+		press((KeyCode)*text++);
+}
+
+bool showsRow(uint8_t y, const char* text)
+{
+	for (uint8_t x = 0; x < printer.width; x++)
+	{
+		if (printer.getCell(x, y) != *text)
+			return false;
+		if (*text)
+			text++;
+	}
+	return *text == '\0';
+}
+
+int main()
+{
+	NumberControl<int> controls[ControlCount];
+	auto list = Array<Control*>::ofSize(ControlCount, nullptr);
+	for (int i = 0; i < ControlCount; i++)
+	{
+		controls[i].header = String("Value ") + i;
+		controls[i].content = propertyOf(&getValue, &setValue);
+		list[i] = &controls[i];
+	}
+	ControlPanel panel("Bench", list);
+	MenuLayout root(Array<MenuPanel*> { &panel });
+	CHECK(context.begin(&printer, root));
+
+	context.update();
+	CHECK(showsRow(0, "      =Bench=       "));
+	CHECK(showsRow(1, "Value 0............0"));
+	CHECK(showsRow(3, "Value 2............0"));
+
+	// Selecting the sixth control scrolls it onto the last row.
+	for (int i = 0; i < 6; i++)
+		press(KeyCode::DownArrow);
+	CHECK_EQUAL(panel.getSelection(), 5);
+	CHECK(showsRow(0, "      <Bench>       "));
+	CHECK(showsRow(1, "Value 3............0"));
+	CHECK(showsRow(3, "> Value 5..........0"));
+
+	printer.resetBusStats();
+	for (int i = 0; i < 100; i++)
+		context.update();
+	CHECK_EQUAL(printer.getBusStats().bytes, 0);
+	CHECK_EQUAL(printer.getBusStats().commands, 0);
+
+	// Typing a caption jumps straight to it, for less than repainting the
+	// three content rows.
+	printer.resetBusStats();
+	typeText("value 23");
+	CHECK_EQUAL(panel.getSelection(), 23);
+	CHECK(showsRow(3, "> Value 23.........0"));
+	CHECK(printer.getBusStats().bytes < 3 * printer.width);
+
+	return CHECK_RESULT();
+}
@@ -47,6 +47,17 @@ public:
 		return arr;
 	}
 
+	/// <summary>
+	/// Creates a non-owning view over existing storage; the storage must outlive it.
+	/// </summary>
+	static Array view(T* data, size_t size)
+	{
+		auto arr = Array();
+		arr.data = data;
+		arr.size = size;
+		return arr;
+	}
+
 	/// <summary>
 	/// Creates an empty array identity;
 	/// </summary>
@@ -65,11 +76,29 @@ public:
 	// Copy assignment
 	Array& operator= (const Array& other)
 	{
+		if (this == &other)
+			return *this;
+		destroyReference();
+		data = other.data;
+		size = other.size;
+		counter = other.counter;
+		if (counter != nullptr)
+			(*counter)++;
+		return *this;
+	}
+
+	// Move assignment
+	Array& operator= (Array&& other)
+	{
+		if (this == &other)
+			return *this;
 		destroyReference();
 		data = other.data;
 		size = other.size;
 		counter = other.counter;
-		(*counter)++;
+		other.data = nullptr;
+		other.size = 0;
+		other.counter = nullptr;
 		return *this;
 	}
 
@@ -78,7 +107,21 @@ public:
 		data = other.data;
 		size = other.size;
 		counter = other.counter;
-		(*counter)++;
+		if (counter != nullptr)
+			(*counter)++;
+	}
+
+	// Keeps non-const copies away from the variadic constructor
+	Array(Array& other) : Array(static_cast<const Array&>(other)) { }
+
+	Array(Array&& other)
+	{
+		data = other.data;
+		size = other.size;
+		counter = other.counter;
+		other.data = nullptr;
+		other.size = 0;
+		other.counter = nullptr;
 	}
 
 	int length() const { return size; }
@@ -100,3 +143,34 @@ public:
 
 template<class T, class... TArgs>
 Array<T> arrayOf(TArgs... args) { return Array<T>(args...); }
+
+template<class T, size_t N>
+Array<T> arrayView(T (&data)[N]) { return Array<T>::view(data, N); }
+
+/// <summary>
+/// Fixed-capacity storage that can be constant-initialized into static RAM.
+/// Converts to a non-owning Array view.
+/// </summary>
+template<class T, size_t N>
+struct StaticArray
+{
+	T items[N];
+
+	int length() const { return N; }
+
+	T& operator[](size_t index) { return items[index]; }
+
+	const T& operator[](size_t index) const { return items[index]; }
+
+	T* begin() { return &items[0]; }
+
+	const T* begin() const { return &items[0]; }
+
+	T* end() { return &items[N]; }
+
+	const T* end() const { return &items[N]; }
+
+	Array<T> view() { return Array<T>::view(items, N); }
+
+	operator Array<T>() { return view(); }
+};
@@ -0,0 +1,79 @@
+#include "Bindings.h"
+
+#pragma region StructBinding
+
+StructBinding::StructBinding(void* source, uint16_t size) : _source((uint8_t*)source), _size(size)
+{
+	_snapshot = new uint8_t[size];
+	_stamps = new uint16_t[(size + ChunkSize - 1) / ChunkSize];
+	memcpy(_snapshot, _source, size);
+	memset(_stamps, 0, (size + ChunkSize - 1) / ChunkSize * sizeof(uint16_t));
+}
+
+StructBinding::~StructBinding()
+{
+	delete[] _snapshot;
+	delete[] _stamps;
+}
+
+// Stamps only grow, so a field's latest stamp moves whenever one of its
+// chunks changes. When the counter wraps, every stamp restarts from zero.
+uint16_t StructBinding::nextStamp()
+{
+	if (++_refresh == 0)
+	{
+		memset(_stamps, 0, (_size + ChunkSize - 1) / ChunkSize * sizeof(uint16_t));
+		_refresh = 1;
+	}
+	return _refresh;
+}
+
+uint16_t StructBinding::refresh()
+{
+	auto stamp = nextStamp();
+	uint16_t changed = 0;
+	for (uint16_t offset = 0, chunk = 0; offset < _size; offset += ChunkSize, chunk++)
+	{
+		uint8_t length = min(uint16_t(_size - offset), uint16_t(ChunkSize));
+		if (memcmp(_snapshot + offset, _source + offset, length) == 0)
+			continue;
+		memcpy(_snapshot + offset, _source + offset, length);
+		_stamps[chunk] = stamp;
+		changed++;
+	}
+	return changed;
+}
+
+uint16_t StructBinding::getVersion(uint16_t offset, uint16_t size) const
+{
+	if (size == 0 || offset + size > _size)
+		return 0;
+
+	uint16_t version = 0;
+	for (uint16_t chunk = offset / ChunkSize; chunk <= (offset + size - 1) / ChunkSize; chunk++)
+		version = max(version, _stamps[chunk]);
+	return version;
+}
+
+void StructBinding::read(uint16_t offset, void* out, uint16_t size) const
+{
+	if (offset + size <= _size)
+		memcpy(out, _snapshot + offset, size);
+}
+
+void StructBinding::write(uint16_t offset, const void* value, uint16_t size)
+{
+	if (size == 0 || offset + size > _size)
+		return;
+
+	memcpy(_source + offset, value, size);
+
+	// Reads come from the snapshot, so the write goes there too and counts
+	// as a change of its own for anything tracking the field's version.
+	memcpy(_snapshot + offset, value, size);
+	auto stamp = nextStamp();
+	for (uint16_t chunk = offset / ChunkSize; chunk <= (offset + size - 1) / ChunkSize; chunk++)
+		_stamps[chunk] = stamp;
+}
+
+#pragma endregion
@@ -0,0 +1,73 @@
+#pragma once
+
+class StructBinding;
+template<class T> class FieldProperty;
+
+#include "Arduino.h"
+#include "Delegate.h"
+
+// Mirrors a struct into a snapshot once per refresh. Changes are found by
+// comparing 4-byte chunks, and each chunk remembers the refresh it last
+// changed in. A field reports the latest refresh among its chunks as its
+// version. Fields are values the caller keeps, so binding allocates
+// nothing per field:
+//
+//   FieldProperty<float> temp = fieldOf(binding, Telemetry, temp);
+//   NumberControl<float> control("Temp", "C", &temp);
+class StructBinding
+{
+private:
+	static const uint8_t ChunkSize = 4;
+
+	uint8_t* _source;
+	uint8_t* _snapshot;
+	uint16_t* _stamps;
+	const uint16_t _size;
+	uint16_t _refresh = 1;
+
+	uint16_t nextStamp();
+
+public:
+	StructBinding(void* source, uint16_t size);
+	StructBinding(const StructBinding&) = delete;
+	StructBinding& operator=(const StructBinding&) = delete;
+	~StructBinding();
+
+	template<class S, typename = typename Traits::EnableIf<!Traits::IsSame<typename Traits::Decay<S>::Type, StructBinding>::value>::Type>
+	StructBinding(S& source) : StructBinding(&source, sizeof(S)) { }
+
+	uint16_t refresh();
+	uint16_t getVersion(uint16_t offset, uint16_t size) const;
+	void read(uint16_t offset, void* out, uint16_t size) const;
+	void write(uint16_t offset, const void* value, uint16_t size);
+
+	template<class T>
+	FieldProperty<T> field(uint16_t offset) { return FieldProperty<T>(*this, offset); }
+};
+
+template<class T>
+class FieldProperty : public Property<T>
+{
+private:
+	StructBinding& _binding;
+	const uint16_t _offset;
+
+public:
+	FieldProperty(StructBinding& binding, uint16_t offset) : _binding(binding), _offset(offset) { }
+
+	T get() override
+	{
+		T value;
+		_binding.read(_offset, &value, sizeof(T));
+		return value;
+	}
+	void set(T value) override { _binding.write(_offset, &value, sizeof(T)); }
+	bool isReadonly() override { return false; }
+	bool tryGetVersion(uint16_t& out) override
+	{
+		out = _binding.getVersion(_offset, sizeof(T));
+		return true;
+	}
+};
+
+#define fieldOf(binding, type, member) ((binding).field<decltype(type::member)>(offsetof(type, member)))
@@ -23,6 +23,11 @@ void Control::onDraw(DrawContext& context)
 	}
 }
 
+TextSpan Control::getCaption() const
+{
+	return TextSpan();
+}
+
 bool Control::onInteract(const Interaction& e)
 {
 	if (!isInteractable())
@@ -113,11 +118,16 @@ bool ButtonControl::isInteractable() const
 	return isEnabled && handler != nullptr;
 }
 
+TextSpan ButtonControl::getCaption() const
+{
+	return content;
+}
+
 ButtonControl::ButtonControl() : ButtonControl("", nullptr)
 {
 }
 
-ButtonControl::ButtonControl(String content, Action* handler, bool isEnabled)
+ButtonControl::ButtonControl(String content, InlineAction handler, bool isEnabled)
 {
 	this->content = content;
 	this->handler = handler;
@@ -150,103 +160,138 @@ bool LabelControl::isInteractable() const
 	return false;
 }
 
+TextSpan LabelControl::getCaption() const
+{
+	return content;
+}
+
 #pragma endregion
 
 #pragma region DataControl
 
 #pragma endregion
 
-#pragma region NumberControl
-
+#pragma region SwitchControl
 
-template<>
-void NumberControl<float>::onDrawContent(DrawContext& context)
+void SwitchControl::onDrawContent(DrawContext& context)
 {
 	if (isDirty(UIFlag::PropertyChanged | UIFlag::FocusChanged))
 	{
-
-		String s = String(content->get(), 1);
-		if (s == "-0.0")
-			s = "0.0";
-
-		auto spacing = suffix.length() > 0 ? suffix.length() + 1 : 0;
-		context.write(s, Alignment::Back, context.getRemaining() - spacing, Glyphs::LinePadding);
-	}
-
-	if (isDirty(UIFlag::GlobalDraw))
-	{
-		if (suffix.length() > 0)
-			context.write(' ');
-		context.write(suffix);
+		char buffer[Capacity];
+		auto value = _lastValue;
+		if (value < 0 || value >= getCount())
+			context.fill(TextSpan(buffer, NumberFormatter::format(buffer, value, NumberFormat())), Alignment::Back, Glyphs::LinePadding);
+		else if (flashOptions != nullptr)
+			context.fill(reinterpret_cast<const __FlashStringHelper*>(pgm_read_ptr(flashOptions + value)), Alignment::Back, Glyphs::LinePadding);
+		else if (generator != nullptr)
+			context.fill(TextSpan(buffer, min(generator->invoke(buffer, Capacity, value), Capacity)), Alignment::Back, Glyphs::LinePadding);
+		else
+			context.fill(options[value], Alignment::Back, Glyphs::LinePadding);
 	}
 }
 
-template<>
-void NumberControl<float>::onManipulate(int sign, KeyState state)
+// Key repeats move a page at a time once the key has been held past the
+// acceleration delay. With wrap set, stepping past either end jumps to the
+// other, but a page never skips over the end.
+void SwitchControl::onManipulate(int sign, KeyState state)
 {
-	if (state == KeyState::Down || state == KeyState::Pressed)
-		content->set(content->get() + sign * 0.1f);
+	auto last = getCount() - 1;
+	if (last >= 0)
+		edit(stepOption(getEditValue(), sign, state, getAcceleration(), last, wrap, pageSize));
 }
 
-template<>
-void NumberControl<int>::onDrawContent(DrawContext& context)
+int32_t SwitchControl::stepOption(int32_t value, int sign, KeyState state, uint16_t acceleration, int32_t last, bool wrap, uint8_t pageSize)
 {
-	if (isDirty(UIFlag::PropertyChanged | UIFlag::FocusChanged))
-	{
-		auto spacing = suffix.length() > 0 ? suffix.length() + 1 : 0;
-		context.write(String(content->get()), Alignment::Back, context.getRemaining() - spacing, Glyphs::LinePadding);
-	}
+	if (wrap && value == (sign > 0 ? last : 0))
+		return sign > 0 ? 0 : last;
 
-	if (isDirty(UIFlag::GlobalDraw))
-	{
-		if (suffix.length() > 0)
-			context.write(' ');
-		context.write(suffix);
-	}
+	int32_t step = state == KeyState::Pressed && acceleration > 1 ? pageSize : 1;
+	return clamp(value + sign * step, (int32_t)0, last);
 }
 
-template<class T>
-void NumberControl<T>::onManipulate(int sign, KeyState state) { }
+int SwitchControl::getCount() const
+{
+	return flashOptions != nullptr || generator != nullptr ? count : options.length();
+}
 
-template<class T>
-void NumberControl<T>::onDrawContent(DrawContext& context) { }
+SwitchControl::SwitchControl() : SwitchControl("", Array<String>(), nullptr)
+{
+}
+
+SwitchControl::SwitchControl(String header, Array<String> options, InlineProperty<int> content)
+{
+	this->header = header;
+	this->options = options;
+	this->content = content;
+}
 
-template<>
-void NumberControl<int>::onManipulate(int sign, KeyState state)
+SwitchControl::SwitchControl(String header, const char* const* options, uint16_t count, InlineProperty<int> content)
 {
-	if (state == KeyState::Down || state == KeyState::Pressed)
-		content->set(content->get() + sign);
+	this->header = header;
+	this->flashOptions = options;
+	this->count = count;
+	this->content = content;
 }
 
+SwitchControl::SwitchControl(String header, OptionGenerator generator, uint16_t count, InlineProperty<int> content)
+{
+	this->header = header;
+	this->generator = generator;
+	this->count = count;
+	this->content = content;
+}
 
 #pragma endregion
 
-#pragma region SwitchControl
+#pragma region GaugeControl
 
-void SwitchControl::onDrawContent(DrawContext& context)
+float GaugeControl::getRatio() const
 {
-	if (isDirty(UIFlag::PropertyChanged | UIFlag::FocusChanged))
+	return maximum > minimum ? (_lastValue - minimum) / (maximum - minimum) : 0.0f;
+}
+
+void GaugeControl::onUpdate()
+{
+	// Pending edits are shown and committed the way any DataControl does.
+	if (_isEditing)
 	{
-		auto value = content->get();
-		auto s = value >= 0 && value < options.length() ? options[value] : String(value);
-		context.fill(s, Alignment::Back, Glyphs::LinePadding);
+		DataControl<float>::onUpdate();
+		return;
 	}
+
+	if (!tryReadContent(_lastValue))
+		return;
+	if (_bar.hasChanged(getRatio(), _cells))
+		invalidate(UIFlag::PropertyChanged);
 }
 
-void SwitchControl::onManipulate(int sign, KeyState state)
+void GaugeControl::onDrawContent(DrawContext& context)
 {
-	if (state == KeyState::Down)
-		content->set(clamp(content->get() + sign, 0, options.length() - 1));
+	if (!context.omit(1, isDirty(UIFlag::FocusChanged)))
+		context.write(' ');
+	_cells = context.getRemaining();
+	_bar.draw(context, getRatio(), _cells, isDirty(UIFlag::FocusChanged));
 }
 
-SwitchControl::SwitchControl() : SwitchControl("", Array<String>(), nullptr)
+void GaugeControl::onManipulate(int sign, KeyState state)
+{
+	if (state != KeyState::Down && state != KeyState::Pressed)
+		return;
+
+	// A writable gauge is a slider that moves one bar unit per step. Until
+	// the first draw sizes the bar, assume it spans the display.
+	auto cells = _cells > 0 ? _cells : getContext().getWidth();
+	auto step = (maximum - minimum) / (cells * BarRenderer::Resolution);
+	edit(clamp(getEditValue() + sign * step, minimum, maximum));
+}
+
+GaugeControl::GaugeControl() : GaugeControl("", nullptr)
 {
 }
 
-SwitchControl::SwitchControl(String header, Array<String> options, Property<int>* content)
+GaugeControl::GaugeControl(String header, InlineProperty<float> content, float minimum, float maximum) : minimum(minimum), maximum(maximum)
 {
 	this->header = header;
-	this->options = options;
 	this->content = content;
 }
 
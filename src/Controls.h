@@ -2,6 +2,7 @@
 
 #include "Arduino.h"
 #include "Delegate.h"
+#include "Formatting.h"
 
 class Control;
 class ButtonControl;
@@ -10,6 +11,7 @@ template<class T> class DataControl;
 template<class T> class NumberControl;
 class SwitchControl;
 template<String& ON, String& OFF> class ToggleControl;
+class GaugeControl;
 
 #include "Crystalline.h"
 
@@ -26,6 +28,8 @@ protected:
 	bool onInteract(const Interaction& interaction);
 public:
 	virtual bool isInteractable() const = 0;
+	// The text type-to-jump searches by.
+	virtual TextSpan getCaption() const;
 };
 
 class ButtonControl : public Control
@@ -37,13 +41,14 @@ protected:
 
 public:
 	ButtonControl();
-	ButtonControl(String content, Action* handler = nullptr, bool isEnabled = true);
+	ButtonControl(String content, InlineAction handler = nullptr, bool isEnabled = true);
 
 	bool isEnabled = true;
 	String content;
-	Action* handler;
+	InlineAction handler;
 	
 	bool isInteractable() const override;
+	TextSpan getCaption() const override;
 };
 
 class LabelControl : public Control
@@ -56,6 +61,7 @@ public:
 	LabelControl(String content);
 
 	bool isInteractable() const override;
+	TextSpan getCaption() const override;
 
 	String content;
 };
@@ -67,21 +73,133 @@ class DataControl : public Control
 public:
 	bool isEnabled = true;
 	String header = "";
-	Property<T>* content = nullptr;
+	InlineProperty<T> content;
+	CommitPolicy commitPolicy = CommitPolicy::Immediate;
+	uint16_t commitDelay = 500;
+	uint16_t accelerationDelay = 500;
 
 	bool isInteractable() const override
 	{
 		return isEnabled && !content->isReadonly();
 	}
 
+	TextSpan getCaption() const override
+	{
+		return header;
+	}
+
+	bool isEditing() const
+	{
+		return _isEditing;
+	}
+
+	void commit()
+	{
+		if (!_isEditing)
+			return;
+		_isEditing = false;
+		content->set(_lastValue);
+	}
+
+	void revert()
+	{
+		if (!_isEditing)
+			return;
+		_isEditing = false;
+		_observed = nullptr;
+		invalidate(_lastValue, quantize(readContent()), UIFlag::PropertyChanged);
+	}
+
 protected:
 	T _lastValue = -1;
+	Property<T>* _observed = nullptr;
+	uint16_t _version = 0;
+	bool _isEditing = false;
+	uint32_t _editTime = 0;
+	uint32_t _holdTime = 0;
+	uint16_t _acceleration = 1;
+
+	T readContent()
+	{
+		CRYSTALLINE_PROFILE(getContext().getCurrentFrame().reads++);
+		return content->get();
+	}
+
+	// Observable properties are only read when their version has moved.
+	bool tryReadContent(T& out)
+	{
+		uint16_t version;
+		if (content->tryGetVersion(version))
+		{
+			if (content.getSource() == _observed && version == _version)
+				return false;
+			_observed = content.getSource();
+			_version = version;
+		}
+		out = readContent();
+		return true;
+	}
+
+	T getEditValue()
+	{
+		return _isEditing ? _lastValue : readContent();
+	}
+
+	// Unless the policy is immediate, edits go to a shadow value in
+	// _lastValue and reach the property once committed.
+	void edit(T value)
+	{
+		if (commitPolicy == CommitPolicy::Immediate)
+		{
+			content->set(value);
+			return;
+		}
+		_isEditing = true;
+		_editTime = getContext().getClock().millis();
+		invalidate(_lastValue, value, UIFlag::PropertyChanged);
+	}
+
+	// Holding a key multiplies the step by ten for every accelerationDelay
+	// it has been held, up to a thousand.
+	void updateAcceleration(KeyState state)
+	{
+		auto now = getContext().getClock().millis();
+		if (state == KeyState::Down)
+			_holdTime = now;
+
+		_acceleration = 1;
+		if (accelerationDelay == 0)
+			return;
+		for (auto held = now - _holdTime; held >= accelerationDelay && _acceleration < 1000; held -= accelerationDelay)
+			_acceleration *= 10;
+	}
 
+	uint16_t getAcceleration() const
+	{
+		return _acceleration;
+	}
+
+	// Values are compared as they will be displayed, so changes that
+	// don't alter the visible text don't redraw the row.
+	virtual T quantize(T value) const { return value; }
 	virtual void onDrawContent(DrawContext& context) = 0;
 	virtual void onManipulate(int sign, KeyState state) = 0;
+	void onFocusLost() override
+	{
+		commit();
+	}
 	void onUpdate() override
 	{
-		invalidate(_lastValue, content->get(), UIFlag::PropertyChanged);
+		if (_isEditing)
+		{
+			if (commitPolicy != CommitPolicy::OnIdle || getContext().getClock().millis() - _editTime < commitDelay)
+				return;
+			commit();
+		}
+
+		T value;
+		if (tryReadContent(value))
+			invalidate(_lastValue, quantize(value), UIFlag::PropertyChanged);
 	}
 	void onDraw(DrawContext& context) override
 	{
@@ -92,12 +210,12 @@ protected:
 	}
 	bool onInteract(const Interaction& e) override
 	{
-		if (Control::onInteract(e))
-			return true;
-
+		// Key repeats are handled here, before Control swallows everything
+		// but the initial press.
 		FocusToken* token;
-		if (requestToken(token) && token->state == FocusState::Engaged)
+		if (isInteractable() && e.state != KeyState::Up && requestToken(token) && token->state == FocusState::Engaged)
 		{
+			updateAcceleration(e.state);
 			switch (e.key)
 			{
 			case KeyCode::LeftArrow:
@@ -108,14 +226,22 @@ protected:
 			case KeyCode::RightArrow:
 			case KeyCode::UpArrow:
 				onManipulate(1, e.state);
-				return true;;
+				return true;
+
+			case KeyCode::Enter:
+				if (e.state == KeyState::Down)
+					commit();
+				break;
+
+			case KeyCode::Escape:
+				if (e.state == KeyState::Down)
+					revert();
+				break;
 			}
 		}
 
-		return false;
+		return Control::onInteract(e);
 	}
-
-
 };
 
 template<class T>
@@ -123,22 +249,64 @@ class NumberControl : public DataControl<T>
 {
 public:
 	String suffix;
+	NumberFormat format = NumberFormat(NumberTraits<T>::precision);
+	T step = NumberTraits<T>::step();
+	T minimum = NumberTraits<T>::minimum();
+	T maximum = NumberTraits<T>::maximum();
 
 	NumberControl() : NumberControl<T>("", "", nullptr)
 	{
 	}
 
-	NumberControl(String header, String suffix, Property<T>* content)
+	NumberControl(String header, String suffix, InlineProperty<T> content)
 	{
 		this->header = header;
 		this->suffix = suffix;
 		this->content = content;
 	}
 
-	void onDrawContent(DrawContext& context) override;
-	void onManipulate(int sign, KeyState state) override;
+	void onDrawContent(DrawContext& context) override
+	{
+		if (this->isDirty(UIFlag::PropertyChanged | UIFlag::FocusChanged))
+		{
+			char buffer[NumberFormat::Capacity];
+			auto length = NumberFormatter::format(buffer, this->_lastValue, format);
+			auto spacing = suffix.length() > 0 ? suffix.length() + 1 : 0;
+			context.write(TextSpan(buffer, length), Alignment::Back, context.getRemaining() - spacing, Glyphs::LinePadding);
+		}
+
+		if (this->isDirty(UIFlag::GlobalDraw))
+		{
+			if (suffix.length() > 0)
+				context.write(' ');
+			context.write(suffix);
+		}
+	}
+
+	T quantize(T value) const override
+	{
+		return NumberFormatter::quantize(value, format);
+	}
+
+	void onManipulate(int sign, KeyState state) override
+	{
+		if (state == KeyState::Down || state == KeyState::Pressed)
+		{
+			T delta = step;
+			for (auto factor = this->getAcceleration(); factor >= 10 && delta <= NumberTraits<T>::maximum() / 10; factor /= 10)
+				delta *= 10;
+			this->edit(NumberFormatter::step(this->getEditValue(), sign, delta, minimum, maximum));
+		}
+	}
 };
 
+// Writes the text of an option into a buffer of the given capacity and
+// returns its length.
+using OptionGenerator = InlineDelegate<uint8_t, char*, uint8_t, int>;
+
+// Options come from one of three sources: an array of Strings, a PROGMEM
+// table of PROGMEM strings, or a generator. The latter two take constant
+// RAM however many options there are.
 class SwitchControl : public DataControl<int>
 {
 protected:
@@ -146,10 +314,30 @@ protected:
 	void onManipulate(int sign, KeyState state) override;
 
 public:
+	static const uint8_t Capacity = 24;
+
 	SwitchControl();
-	SwitchControl(String header, Array<String> options, Property<int>* content);
+	SwitchControl(String header, Array<String> options, InlineProperty<int> content);
+	SwitchControl(String header, const char* const* options, uint16_t count, InlineProperty<int> content);
+	SwitchControl(String header, OptionGenerator generator, uint16_t count, InlineProperty<int> content);
+
+	template<size_t N>
+	SwitchControl(String header, const char* const (&options)[N], InlineProperty<int> content) : SwitchControl(header, options, N, content) { }
 
 	Array<String> options;
+	const char* const* flashOptions = nullptr;
+	OptionGenerator generator;
+	uint16_t count = 0;
+	bool wrap = false;
+	uint8_t pageSize = DefaultPageSize;
+
+	int getCount() const;
+
+	static const uint8_t DefaultPageSize = 10;
+
+	// The option an arrow press moves to from value, among options 0 to
+	// last. Held keys jump a page at a time.
+	static int32_t stepOption(int32_t value, int sign, KeyState state, uint16_t acceleration, int32_t last, bool wrap, uint8_t pageSize);
 };
 
 template<String& ON = Glyphs::DefaultOn, String& OFF = Glyphs::DefaultOff>
@@ -160,7 +348,7 @@ protected:
 	{
 		if (isDirty(UIFlag::PropertyChanged | UIFlag::FocusChanged))
 		{
-			context.fill(content->get() ? ON : OFF, Alignment::Back, Glyphs::LinePadding);
+			context.fill(_lastValue ? ON : OFF, Alignment::Back, Glyphs::LinePadding);
 		}
 	}
 
@@ -168,15 +356,34 @@ protected:
 	{
 		{
 			if (state == KeyState::Down)
-				content->set(!content->get());
+				edit(!getEditValue());
 		}
 	}
 
 public:
 	ToggleControl() : ToggleControl<ON, OFF>("", nullptr) { }
-	ToggleControl(String header, Property<bool>* content)
+	ToggleControl(String header, InlineProperty<bool> content)
 	{
 		this->header = header;
 		this->content = content;
 	}
 };
+
+class GaugeControl : public DataControl<float>
+{
+protected:
+	uint8_t _cells = 0;
+	BarRenderer _bar;
+
+	float getRatio() const;
+	void onUpdate() override;
+	void onDrawContent(DrawContext& context) override;
+	void onManipulate(int sign, KeyState state) override;
+
+public:
+	GaugeControl();
+	GaugeControl(String header, InlineProperty<float> content, float minimum = 0.0f, float maximum = 1.0f);
+
+	float minimum;
+	float maximum;
+};
@@ -1,4 +1,5 @@
 #include "Crystalline.h"
+#include "Recorder.h"
 
 #pragma region Common
 
@@ -26,6 +27,12 @@ char Glyphs::LoadingBar = '#';
 
 char Glyphs::LinePadding = '.';
 
+Clock& Clock::system()
+{
+    static Clock clock;
+    return clock;
+}
+
 char Glyphs::getPointerGlyph(CursorState state)
 {
     switch (state)
@@ -46,83 +53,244 @@ char Glyphs::getPointerGlyph(CursorState state)
 
 #pragma endregion
 
-#pragma region Crystalline
+#pragma region BarRenderer
+
+uint16_t BarRenderer::quantize(float value, uint8_t cells)
+{
+    return clamp(value, 0.0f, 1.0f) * cells * Resolution + 0.5f;
+}
+
+bool BarRenderer::hasChanged(float value, uint8_t cells) const
+{
+    return _units < 0 || quantize(value, cells) != _units;
+}
+
+void BarRenderer::draw(DrawContext& context, float value, uint8_t cells, bool redraw)
+{
+    int16_t units = quantize(value, cells);
+    uint8_t first = 0;
+    uint8_t last = cells;
+
+    // Only the cells between the previous and the new leading edge differ.
+    if (!redraw && _units >= 0)
+    {
+        first = min(units, _units) / Resolution;
+        last = min(int16_t((max(units, _units) + Resolution - 1) / Resolution), int16_t(cells));
+    }
+
+    _units = units;
+    context.omit(first, false);
+    for (uint8_t i = first; i < last; i++)
+        context.write(getCell(context, i, units));
+    context.omit(cells - last, false);
+}
+
+char BarRenderer::getCell(DrawContext& context, uint8_t cell, uint16_t units) const
+{
+    int fill = units - cell * Resolution;
+    if (fill >= Resolution)
+        return Glyphs::LoadingBar;
+    if (fill <= 0)
+        return Glyphs::DefaultPadding;
+
+    uint8_t bitmap[8];
+    memset(bitmap, (0x1F << (Resolution - fill)) & 0x1F, sizeof(bitmap));
+    return context.glyph(Glyphs::LoadingBarId + fill, bitmap, Glyphs::DefaultPadding);
+}
+
+#pragma endregion
+
+#pragma region Histogram
 
-void Crystalline::resolveFocus()
+Histogram::Histogram()
+{
+    reset();
+}
+
+uint16_t Histogram::count() const
+{
+    return _count;
+}
+
+uint32_t Histogram::minimum() const
+{
+    return _count > 0 ? _minimum : 0;
+}
+
+uint32_t Histogram::maximum() const
+{
+    return _maximum;
+}
+
+uint32_t Histogram::percentile(uint8_t percent) const
+{
+    if (_count == 0)
+        return 0;
+
+    // Buckets are powers of two, so the result is the upper bound of the
+    // bucket the percentile falls into, narrowed by the observed extremes.
+    uint32_t rank = ((uint32_t)_count * min(percent, (uint8_t)100) + 99) / 100;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < Buckets; i++)
+    {
+        seen += _buckets[i];
+        if (seen >= rank && seen > 0)
+            return clamp((uint32_t(1) << i) - 1, _minimum, _maximum);
+    }
+    return _maximum;
+}
+
+void Histogram::record(uint32_t value)
+{
+    if (_count == 0xFFFF)
+    {
+        _count = 0;
+        for (auto& bucket : _buckets)
+        {
+            bucket -= bucket / 2;
+            _count += bucket;
+        }
+    }
+
+    uint8_t i = 0;
+    while (i < Buckets - 1 && (value >> i) != 0)
+        i++;
+
+    _buckets[i]++;
+    _count++;
+    _minimum = min(_minimum, value);
+    _maximum = max(_maximum, value);
+}
+
+void Histogram::reset()
+{
+    memset(_buckets, 0, sizeof(_buckets));
+    _count = 0;
+    _minimum = 0xFFFFFFFF;
+    _maximum = 0;
+}
+
+#pragma endregion
+
+#pragma region UIContext
+
+void UIContext::resolveFocus()
 {
     auto* focus = getCurrentView()->resolveFocus();
     if (_focus != focus)
     {
         if (_focus != nullptr)
+        {
+            _focus->onFocusLost();
             _focus->invalidate(UIFlag::FocusLost);
+        }
 
         _focus = focus;
-        _token = FocusToken();
+        _token = FocusToken(*_clock);
 
         if (_focus != nullptr)
             _focus->invalidate(UIFlag::FocusGot);
     }
 }
 
-void Crystalline::showCore(UILayout& overlay)
+uint8_t UIContext::getFocusRow()
+{
+    for (int i = 0; i < _content.length(); i++)
+        if (_content[i] != nullptr && _content[i] == _focus)
+            return i;
+    return 0;
+}
+
+void UIContext::showCore(UILayout& overlay)
 {
     if (_overlay != &overlay)
         hideCore();
     _overlay = &overlay;
 }
 
-void Crystalline::hideCore()
+void UIContext::hideCore()
 {
     _overlay = nullptr;
 }
 
-uint8_t Crystalline::getWidth()
+uint8_t UIContext::getWidth()
 {
     return _printer->width;
 }
 
-uint8_t Crystalline::getHeight()
+uint8_t UIContext::getHeight()
 {
     return _printer->height;
 }
 
-bool Crystalline::hasOverlay()
+PrinterBase* UIContext::getPrinter()
+{
+    return _printer;
+}
+
+const Clock& UIContext::getClock() const
+{
+    return *_clock;
+}
+
+void UIContext::setClock(const Clock& clock)
+{
+    _clock = &clock;
+    _token.timer = Timer(clock);
+}
+
+void UIContext::setRecorder(Recorder* recorder)
+{
+    _recorder = recorder;
+}
+
+bool UIContext::hasOverlay()
 {
     return _overlay != nullptr;
 }
 
-UILayout* Crystalline::getRoot()
+UILayout* UIContext::getRoot()
 {
     return _root;
 }
 
-UILayout* Crystalline::getOverlay()
+UILayout* UIContext::getOverlay()
 {
     return _overlay;
 }
 
-UILayout* Crystalline::getCurrentView()
+UILayout* UIContext::getCurrentView()
 {
     return _overlay != nullptr ? _overlay : _root;
 }
 
-UIElement* Crystalline::getCurrentFocus()
+UIElement* UIContext::getCurrentFocus()
 {
     return _focus;
 }
 
-void Crystalline::invalidateView()
+void UIContext::invalidateView()
 {
     invalidateFocus();
     _globalDrawFlag = true;
 }
 
-void Crystalline::invalidateFocus()
+void UIContext::invalidateFocus()
 {
     _resolveFocusFlag = true;
 }
 
-bool Crystalline::requestToken(const UIElement& element, FocusToken*& out)
+void UIContext::invalidateRows(RowMask rows)
+{
+    _dirtyRows |= rows;
+}
+
+bool UIContext::hasDirtyRows(RowMask rows) const
+{
+    return (_dirtyRows & rows) != 0;
+}
+
+bool UIContext::requestToken(const UIElement& element, FocusToken*& out)
 {
     if (_focus == &element)
     {
@@ -136,65 +304,83 @@ bool Crystalline::requestToken(const UIElement& element, FocusToken*& out)
     }
 }
 
-bool Crystalline::isFocused(const UIElement& element)
+bool UIContext::isFocused(const UIElement& element)
 {
     return _focus == &element;
 }
 
-void Crystalline::navigate(UILayout& root, bool reset)
+void UIContext::navigate(UILayout& root, bool reset)
 {
     if (_root != &root)
     {
         hideCore();
         _root = &root;
+        _root->_context = this;
         invalidateView();
         if (reset)
             _root->reset();
     }
 }
 
-void Crystalline::show(UILayout& overlay, bool reset)
+void UIContext::show(UILayout& overlay, bool reset)
 {
     showCore(overlay);
+    overlay._context = this;
     if (reset)
         overlay.reset();
     invalidateView();
 }
 
-void Crystalline::hide()
+void UIContext::hide()
 {
     hideCore();
     invalidateView();
 }
 
-void Crystalline::begin(PrinterBase* printer, UILayout& root)
+bool UIContext::begin(PrinterBase* printer, UILayout& root)
 {
+    if (printer == nullptr || printer->height > CRYSTALLINE_MAX_ROWS)
+        return false;
+
     _printer = printer;
-    _content = Array<UIContent*>::ofSize(getHeight(), nullptr);
+    _content = Array<UIContent*>::view(_rows, getHeight());
+    for (auto& content : _content)
+        content = nullptr;
     navigate(root);
     invalidateView();
+    return true;
 }
 
-void Crystalline::end()
+void UIContext::end()
 {
     _printer = nullptr;
     _root = nullptr;
     _overlay = nullptr;
     _focus = nullptr;
+    _dirtyRows = 0;
     _content = Array<UIContent*>();
 }
 
-void Crystalline::update()
+bool UIContext::update(uint32_t budgetMicros)
 {
+    if (_printer == nullptr)
+        return true;
+
+    auto budget = Budget(budgetMicros, *_clock);
     auto globalDrawFlag = _globalDrawFlag;
     auto resolveFocusFlag = _resolveFocusFlag;
     _globalDrawFlag = false;
     _resolveFocusFlag = false;
+    CRYSTALLINE_PROFILE(auto phase = budget.start);
+
+    if (_recorder != nullptr)
+        _recorder->frame(budget.start);
 
     if (resolveFocusFlag)
         resolveFocus();
 
     _token.update();
+    CRYSTALLINE_PROFILE(_frame.focusMicros = _clock->micros() - phase; phase += _frame.focusMicros);
 
     auto* view = getCurrentView();
     
@@ -202,47 +388,303 @@ void Crystalline::update()
     for (auto* content : _content)
         if (content != nullptr)
             content->update();
+    CRYSTALLINE_PROFILE(_frame.updateMicros = _clock->micros() - phase; phase += _frame.updateMicros);
 
-    view->draw(Range(0, getHeight() - 1), globalDrawFlag);
-    for (int i = 0; i < _content.length(); i++)
-        if (_content[i] != nullptr)
-            _content[i]->draw(*_printer->begin(i), globalDrawFlag);
+    auto expired = false;
+    auto first = getFocusRow();
+    auto needsDraw = globalDrawFlag || _dirtyRows != 0 || view->isDirty();
 
+    // Layouts draw all their rows in one go. When the update phase has spent
+    // the budget already, they wait for the next frame, though never twice in
+    // a row, so slow updates can't starve the display.
+    if (needsDraw && budget.isSpent() && !_drawDeferred)
+    {
+        _drawDeferred = true;
+        _globalDrawFlag |= globalDrawFlag;
+        expired = true;
+        needsDraw = false;
+    }
+
+    if (needsDraw)
+    {
+        _drawDeferred = false;
+        view->draw(Range(0, getHeight() - 1), globalDrawFlag);
+
+        // The focused row is drawn first, the others resume at the row where
+        // the budget ran out last time. The budget is checked between rows,
+        // after at least one was drawn. Rows that don't fit stay dirty.
+        auto dirty = _dirtyRows;
+        auto rows = _content.length();
+        uint8_t drawn = 0;
+        _dirtyRows = 0;
+        for (int n = 0; n <= rows; n++)
+        {
+            int i = n == 0 ? first : (_pendingRow + n - 1) % rows;
+            if (n > 0 && i == first)
+                continue;
+
+            auto* content = _content[i];
+            if (content == nullptr || !(globalDrawFlag || (dirty & rowMaskOf(i))))
+                continue;
+
+            if (!expired && drawn > 0 && budget.isSpent())
+            {
+                expired = true;
+                _pendingRow = i;
+            }
+
+            if (expired)
+            {
+                if (globalDrawFlag)
+                    content->invalidate(UIFlag::GlobalDraw);
+                else
+                    invalidateRows(rowMaskOf(i));
+            }
+            else
+            {
+                content->draw(*_printer->begin(i), globalDrawFlag);
+                _dirtyRows &= ~rowMaskOf(i);
+                drawn++;
+            }
+        }
+    }
+
+    // Content that wasn't drawn this frame may still show a glyph whose
+    // slot was just redefined. Drawing it again makes it ask for the glyph
+    // anew. Slots used this frame are never evicted, so this settles.
+    for (auto evicted = _printer->getEvictedRows(); evicted != 0; evicted = _printer->getEvictedRows())
+    {
+        _printer->clearEvictedRows();
+        for (int i = 0; i < _content.length(); i++)
+        {
+            if (!(evicted & rowMaskOf(i)))
+                continue;
+            if (_content[i] == nullptr)
+            {
+                invalidateView();
+                continue;
+            }
+            _content[i]->draw(*_printer->begin(i), true);
+            _dirtyRows &= ~rowMaskOf(i);
+        }
+    }
+    CRYSTALLINE_PROFILE(_frame.drawMicros = _clock->micros() - phase; phase += _frame.drawMicros);
+
+    CRYSTALLINE_PROFILE(auto pending = _printer->getPendingStats());
+    auto flushed = _printer->flush(budget.remaining(), first);
+#ifdef CRYSTALLINE_PROFILING
+    _frame.flushMicros = _clock->micros() - phase;
+
+    // A flush spread over several frames is counted in each of them, as
+    // far as it got.
+    auto& stats = flushed ? _printer->getStats() : _printer->getPendingStats();
+    _frame.written = stats.written - pending.written;
+    _frame.skipped = stats.skipped - pending.skipped;
+    _frame.moves = stats.moves - pending.moves;
+    _frameMicros.record(_frame.totalMicros());
+    _lastFrame = _frame;
+    _frame = FrameStats();
+#endif
+    return flushed && !expired;
 }
 
-void Crystalline::interact(const Interaction& interaction)
+void UIContext::interact(const Interaction& interaction)
 {
+    if (_printer == nullptr)
+        return;
+    if (_recorder != nullptr)
+        _recorder->interaction(interaction, _clock->micros());
     getCurrentView()->interact(interaction);
 }
 
-void Crystalline::draw(int row, UIContent& content)
+void UIContext::draw(int row, UIContent& content)
 {
     if (_content[row] == &content)
         return;
-    content.invalidate(UIFlag::GlobalDraw);
+
+    // The replaced content may have scrolled onto another row already, so
+    // only this row's bit is released.
+    if (_content[row] != nullptr)
+        _content[row]->_rows &= ~rowMaskOf(row);
     _content[row] = &content;
+    content._context = this;
+    content._rows = rowMaskOf(row);
+    content.update();
+    content.invalidate(UIFlag::GlobalDraw);
 }
 
-DrawContext& Crystalline::draw(int row)
+DrawContext& UIContext::draw(int row)
 {
+    if (_content[row] != nullptr)
+        _content[row]->_rows &= ~rowMaskOf(row);
     _content[row] = nullptr;
     return *_printer->begin(row);
 }
 
-UILayout* Crystalline::_root = nullptr;
+#ifdef CRYSTALLINE_PROFILING
+
+FrameStats& UIContext::getCurrentFrame()
+{
+    return _frame;
+}
+
+const FrameStats& UIContext::getLastFrame() const
+{
+    return _lastFrame;
+}
+
+const Histogram& UIContext::getFrameHistogram() const
+{
+    return _frameMicros;
+}
+
+void UIContext::resetProfile()
+{
+    _frame = FrameStats();
+    _lastFrame = FrameStats();
+    _frameMicros.reset();
+}
+
+#endif
+
+#pragma endregion
+
+#pragma region Crystalline
+
+UIContext& Crystalline::getDefault()
+{
+    return _default;
+}
+
+uint8_t Crystalline::getWidth()
+{
+    return _default.getWidth();
+}
+
+uint8_t Crystalline::getHeight()
+{
+    return _default.getHeight();
+}
+
+void Crystalline::setClock(const Clock& clock)
+{
+    _default.setClock(clock);
+}
+
+void Crystalline::setRecorder(Recorder* recorder)
+{
+    _default.setRecorder(recorder);
+}
+
+bool Crystalline::hasOverlay()
+{
+    return _default.hasOverlay();
+}
+
+UILayout* Crystalline::getRoot()
+{
+    return _default.getRoot();
+}
+
+UILayout* Crystalline::getOverlay()
+{
+    return _default.getOverlay();
+}
+
+UILayout* Crystalline::getCurrentView()
+{
+    return _default.getCurrentView();
+}
+
+UIElement* Crystalline::getCurrentFocus()
+{
+    return _default.getCurrentFocus();
+}
+
+void Crystalline::invalidateView()
+{
+    _default.invalidateView();
+}
+
+void Crystalline::invalidateFocus()
+{
+    _default.invalidateFocus();
+}
+
+bool Crystalline::requestToken(const UIElement& element, FocusToken*& out)
+{
+    return _default.requestToken(element, out);
+}
+
+bool Crystalline::isFocused(const UIElement& element)
+{
+    return _default.isFocused(element);
+}
 
-UILayout* Crystalline::_overlay = nullptr;
+void Crystalline::navigate(UILayout& root, bool reset)
+{
+    _default.navigate(root, reset);
+}
 
-UIElement* Crystalline::_focus = nullptr;
+void Crystalline::show(UILayout& overlay, bool reset)
+{
+    _default.show(overlay, reset);
+}
 
-bool Crystalline::_globalDrawFlag = false;
+void Crystalline::hide()
+{
+    _default.hide();
+}
 
-bool Crystalline::_resolveFocusFlag = false;
+bool Crystalline::begin(PrinterBase* printer, UILayout& root)
+{
+    return _default.begin(printer, root);
+}
 
-FocusToken Crystalline::_token = FocusToken();
+void Crystalline::end()
+{
+    _default.end();
+}
+
+bool Crystalline::update(uint32_t budgetMicros)
+{
+    return _default.update(budgetMicros);
+}
+
+void Crystalline::interact(const Interaction& interaction)
+{
+    _default.interact(interaction);
+}
+
+void Crystalline::draw(int row, UIContent& content)
+{
+    _default.draw(row, content);
+}
+
+DrawContext& Crystalline::draw(int row)
+{
+    return _default.draw(row);
+}
+
+#ifdef CRYSTALLINE_PROFILING
+
+const FrameStats& Crystalline::getLastFrame()
+{
+    return _default.getLastFrame();
+}
+
+const Histogram& Crystalline::getFrameHistogram()
+{
+    return _default.getFrameHistogram();
+}
+
+void Crystalline::resetProfile()
+{
+    _default.resetProfile();
+}
 
-PrinterBase* Crystalline::_printer = nullptr;
+#endif
 
-Array<UIContent*> Crystalline::_content;
+UIContext Crystalline::_default;
 
 #pragma endregion
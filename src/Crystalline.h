@@ -2,12 +2,30 @@
 
 #include "Arduino.h"
 #include "Array.h"
+#include "TextSpan.h"
 
 #define clamp(value, minValue, maxValue) (max(minValue, min(maxValue, value)))
 
+// The tallest display a context can drive; begin() rejects taller printers.
+// It sizes UIContext, so it has to be the same in every translation unit:
+// set it as a compiler flag (-DCRYSTALLINE_MAX_ROWS=8), not with a #define
+// in the sketch, which the library's own sources never see.
+#ifndef CRYSTALLINE_MAX_ROWS
+#define CRYSTALLINE_MAX_ROWS 4
+#endif
+
+// Adds frame counters and timings to UIContext. It changes the class
+// layout too, so like CRYSTALLINE_MAX_ROWS it must be a compiler flag
+// (-DCRYSTALLINE_PROFILING) seen by the library and the sketch alike.
+#ifdef CRYSTALLINE_PROFILING
+#define CRYSTALLINE_PROFILE(statement) statement
+#else
+#define CRYSTALLINE_PROFILE(statement)
+#endif
+
 #pragma region Enums
 
-enum class UIFlag : uint8_t
+enum class UIFlag : uint16_t
 {
 	None = 0x00,
 	PropertyChanged = 0x01,
@@ -19,12 +37,14 @@ enum class UIFlag : uint8_t
 	FocusChanged = 0x30,
 	LocalReset = 0x40,
 	GlobalDraw = 0x80,
-	Any = 0xFF,
+	Own = 0xFF,
+	ChildDirty = 0x100,
+	Any = 0x1FF,
 };
 
 inline UIFlag operator | (UIFlag lhs, UIFlag rhs)
 {
-	return UIFlag(uint8_t(lhs) | uint8_t(rhs));
+	return UIFlag(uint16_t(lhs) | uint16_t(rhs));
 }
 
 inline UIFlag& operator |= (UIFlag& lhs, UIFlag rhs)
@@ -35,7 +55,7 @@ inline UIFlag& operator |= (UIFlag& lhs, UIFlag rhs)
 
 inline UIFlag operator & (UIFlag lhs, UIFlag rhs)
 {
-	return UIFlag(uint8_t(lhs) & uint8_t(rhs));
+	return UIFlag(uint16_t(lhs) & uint16_t(rhs));
 }
 
 inline UIFlag& operator &= (UIFlag& lhs, UIFlag rhs)
@@ -84,6 +104,12 @@ enum class FocusState : uint8_t {
 	Pressed,
 };
 
+enum class CommitPolicy : uint8_t {
+	Immediate,
+	OnIdle,
+	OnConfirm,
+};
+
 enum class CursorState : uint8_t {
 	PointerOver,
 	PointerDisabled,
@@ -94,6 +120,15 @@ enum class CursorState : uint8_t {
 
 #pragma region Common
 
+using RowMask = uint16_t;
+
+static_assert(CRYSTALLINE_MAX_ROWS <= 16, "CRYSTALLINE_MAX_ROWS can't exceed the bits in RowMask");
+
+inline RowMask rowMaskOf(int row)
+{
+	return row >= 0 && row < 16 ? RowMask(1) << row : 0;
+}
+
 struct Range
 {
 	const int start;
@@ -104,6 +139,14 @@ struct Range
 
 	int length() const { return max(end - start + 1, 0); }
 
+	RowMask mask() const
+	{
+		RowMask mask = 0;
+		for (int i = start; i <= end; i++)
+			mask |= rowMaskOf(i);
+		return mask;
+	}
+
 	Range withMargin(int start, int end) const { return Range(this->start + start, this->end - end); }
 
 	Range withLength(int length, Alignment alignment) const {
@@ -120,22 +163,74 @@ struct Range
 	}
 };
 
+class Clock
+{
+public:
+	virtual uint32_t micros() const { return ::micros(); }
+	virtual uint32_t millis() const { return ::millis(); }
+
+	static Clock& system();
+};
+
+class ManualClock : public Clock
+{
+private:
+	uint32_t _micros = 0;
+
+public:
+	uint32_t micros() const override { return _micros; }
+	uint32_t millis() const override { return _micros / 1000; }
+
+	void set(uint32_t micros) { _micros = micros; }
+	void advance(uint32_t micros) { _micros += micros; }
+};
+
 class Timer
 {
 private:
-	uint8_t _timestamp = 0;
+	const Clock* _clock;
+	uint32_t _millis;
+	uint32_t _micros;
 
 public:
-	uint8_t elapsed() { return millis() - _timestamp; }
-	bool hasElapsed(uint8_t interval) { return elapsed() >= interval; }
-	void reset() { _timestamp = millis(); }
+	Timer(const Clock& clock = Clock::system()) : _clock(&clock), _millis(clock.millis()), _micros(clock.micros()) { }
+
+	uint32_t elapsed() const { return _clock->millis() - _millis; }
+	uint32_t elapsedMicros() const { return _clock->micros() - _micros; }
+	bool hasElapsed(uint32_t interval) const { return elapsed() >= interval; }
+	void reset()
+	{
+		_millis = _clock->millis();
+		_micros = _clock->micros();
+	}
+};
+
+struct Budget
+{
+	const Clock& clock;
+	const uint32_t start;
+	const uint32_t limit;
+
+	Budget(uint32_t limit = 0, const Clock& clock = Clock::system()) : clock(clock), start(clock.micros()), limit(limit) { }
+
+	bool isSpent() const { return limit > 0 && clock.micros() - start >= limit; }
+	uint32_t remaining() const
+	{
+		if (limit == 0)
+			return 0;
+		uint32_t elapsed = clock.micros() - start;
+		return elapsed < limit ? limit - elapsed : 1;
+	}
 };
 
 struct FocusToken
 {
 	CursorState cursor = CursorState::PointerOver;
 	FocusState state = FocusState::Normal;
-	Timer timer = Timer();
+	Timer timer;
+
+	FocusToken(const Clock& clock = Clock::system()) : timer(clock) { }
+
 	void update() { }
 };
 
@@ -175,6 +270,8 @@ struct Glyphs
 
 	static char LoadingBar;
 
+	static const uint8_t LoadingBarId = 0xF0;
+
 	static char getPointerGlyph(CursorState state);
 };
 
@@ -190,27 +287,127 @@ public:
 	virtual uint8_t getTotal() const = 0;
 
 	virtual void write(char c) = 0;
-	virtual void write(String s) = 0;
-	virtual void write(String s, Alignment alignment, uint8_t total, char padding = Glyphs::DefaultPadding) = 0;
+	virtual void writeSpan(const char* s, uint8_t length) = 0;
+	virtual void write(TextSpan s) = 0;
+	virtual void write(TextSpan s, Alignment alignment, uint8_t total, char padding = Glyphs::DefaultPadding) = 0;
 	virtual void fill(char c = Glyphs::DefaultPadding) = 0;
 	virtual void fill(char prefix, char infix, char postfix) = 0;
-	virtual void fill(String s, Alignment aligment = Alignment::Front, char padding = Glyphs::DefaultPadding) = 0;
+	virtual void fill(TextSpan s, Alignment aligment = Alignment::Front, char padding = Glyphs::DefaultPadding) = 0;
+	virtual void fill(char prefix, TextSpan s, char postfix, Alignment alignment = Alignment::Front, char padding = Glyphs::DefaultPadding) = 0;
 	virtual void repeat(char c, uint8_t count) = 0;
 	virtual void repeat(char prefix, char infix, char postfix, uint8_t count) = 0;
 	virtual bool omit(uint8_t count, bool check) = 0;
+	virtual char glyph(uint8_t id, const uint8_t* bitmap, char fallback) = 0;
+};
+
+class BarRenderer
+{
+private:
+	int16_t _units = -1;
+
+	char getCell(DrawContext& context, uint8_t cell, uint16_t units) const;
+
+public:
+	static const uint8_t Resolution = 5;
+
+	static uint16_t quantize(float value, uint8_t cells);
+
+	bool hasChanged(float value, uint8_t cells) const;
+	void draw(DrawContext& context, float value, uint8_t cells, bool redraw = false);
+};
+
+struct PrintStats
+{
+	uint16_t written = 0;
+	uint16_t skipped = 0;
+	uint16_t bridged = 0;
+	uint16_t moves = 0;
+	uint16_t merged = 0;
+};
+
+struct FrameStats
+{
+	uint16_t updated = 0;
+	uint16_t drawn = 0;
+	uint16_t reads = 0;
+	uint16_t written = 0;
+	uint16_t skipped = 0;
+	uint16_t moves = 0;
+	uint32_t focusMicros = 0;
+	uint32_t updateMicros = 0;
+	uint32_t drawMicros = 0;
+	uint32_t flushMicros = 0;
+
+	uint32_t totalMicros() const { return focusMicros + updateMicros + drawMicros + flushMicros; }
+};
+
+class Histogram
+{
+private:
+	static const uint8_t Buckets = 20;
+
+	uint16_t _buckets[Buckets];
+	uint16_t _count;
+	uint32_t _minimum;
+	uint32_t _maximum;
+
+public:
+	Histogram();
+
+	uint16_t count() const;
+	uint32_t minimum() const;
+	uint32_t maximum() const;
+	uint32_t percentile(uint8_t percent) const;
+
+	void record(uint32_t value);
+	void reset();
+};
+
+struct GlyphSlot
+{
+	bool isDefined = false;
+	uint8_t id = 0;
+	uint16_t used = 0;
+	uint8_t bitmap[8];
 };
 
 class PrinterBase : public DrawContext
 {
+private:
+	static const uint8_t GlyphSlots = 8;
+
+	char* _buffer;
+	char* _frame;
+	uint8_t* _known;
+	uint8_t* _dirtyStart;
+	uint8_t* _dirtyEnd;
+	uint8_t _resumeRow = 0;
+	GlyphSlot* _glyphs = nullptr;
+	uint16_t _glyphClock = 1;
+	RowMask _evictedRows = 0;
+	PrintStats _stats;
+	PrintStats _lastStats;
+	uint32_t _revision = 0;
+
+	bool isKnown(uint16_t cell) const;
+	bool isChanged(uint16_t cell) const;
+	bool flushRow(uint8_t y, const Budget& budget);
+	bool flushSpan(uint8_t y, uint8_t start, uint8_t end);
+
 protected:
 	uint8_t posX, posY, virtualX, virtualY;
 
-	PrinterBase(uint8_t width, uint8_t height);
+	PrinterBase(uint8_t width, uint8_t height, uint8_t moveCost = 1, uint8_t printCost = 1);
 
 	virtual bool printCore(char c) = 0;
 	virtual bool moveCore(uint8_t x, uint8_t y) = 0;
+	virtual uint8_t getCapacity() const { return 255; }
+	virtual bool defineCore(uint8_t slot, const uint8_t* bitmap) { return false; }
+
+	const uint8_t* getGlyphBitmap(uint8_t slot) const;
 
 	void print(char c);
+	uint8_t align(uint8_t length, Alignment alignment, uint8_t total) const;
 	bool ensureMove();
 	bool move(uint8_t x, uint8_t y);
 	void virtualMove(uint8_t x, uint8_t y);
@@ -218,6 +415,22 @@ protected:
 public:
 	const uint8_t width;
 	const uint8_t height;
+	const uint8_t moveCost;
+	const uint8_t printCost;
+
+	// The buffers are owned, so printers can't be copied.
+	PrinterBase(const PrinterBase&) = delete;
+	PrinterBase& operator=(const PrinterBase&) = delete;
+	virtual ~PrinterBase();
+
+	const PrintStats& getStats() const;
+	const PrintStats& getPendingStats() const;
+	uint32_t getRevision() const;
+	void invalidate();
+	void invalidate(uint8_t x, uint8_t y, uint8_t length);
+	bool flush(uint32_t budgetMicros = 0, uint8_t firstRow = 0);
+	RowMask getEvictedRows() const;
+	void clearEvictedRows();
 
 	uint8_t getRemaining() const override;
 	uint8_t getPosition() const override;
@@ -226,29 +439,47 @@ public:
 	DrawContext* begin(int row);
 
 	void write(char c) override;
-	void write(String s) override;
-	void write(String s, Alignment alignment, uint8_t total, char padding = Glyphs::DefaultPadding) override;
+	void writeSpan(const char* s, uint8_t length) override;
+	void write(TextSpan s) override;
+	void write(TextSpan s, Alignment alignment, uint8_t total, char padding = Glyphs::DefaultPadding) override;
 	void fill(char c = Glyphs::DefaultPadding) override;
 	void fill(char prefix, char infix, char postfix) override;
-	void fill(String s, Alignment aligment, char padding = Glyphs::DefaultPadding) override;
+	void fill(TextSpan s, Alignment aligment = Alignment::Front, char padding = Glyphs::DefaultPadding) override;
+	void fill(char prefix, TextSpan s, char postfix, Alignment alignment = Alignment::Front, char padding = Glyphs::DefaultPadding) override;
 	void repeat(char c, uint8_t count) override;
 	void repeat(char prefix, char infix, char postfix, uint8_t count) override;
 	bool omit(uint8_t count, bool check) override;
+	char glyph(uint8_t id, const uint8_t* bitmap, char fallback) override;
 };
 
 #pragma endregion
 
 #pragma region UIBase
 
+class UIContext;
+class Recorder;
+
+class PopupManager;
+
 class UIElement
 {
+	friend class UIContext;
+	friend class PopupManager;
+
 protected:
 	UIFlag _flags = UIFlag::None;
+	UIContext* _context = nullptr;
+	UIElement* _parent = nullptr;
+	RowMask _rows = 0;
+
+	UIContext& getContext() const;
+	UIElement* adopt(UIElement* child);
 
 	virtual UIElement* focusSource() const { return nullptr; }
 
 	virtual void onReset() { }
 	virtual void onUpdate() { }
+	virtual void onFocusLost() { }
 	virtual void onValidate() { }
 	virtual bool onInteract(const Interaction& interaction) { return false; }
 
@@ -256,6 +487,7 @@ public:
 	bool isDirty(UIFlag flag = UIFlag::Any) const;
 	bool isFocused() const;
 	UIFlag getFlags() const;
+	UIElement* getParent() const;
 
 
 	void invalidate(UIFlag flag);
@@ -300,25 +532,82 @@ public:
 
 #pragma endregion
 
+class UIContext
+{
+private:
+	UILayout* _root = nullptr;
+	UILayout* _overlay = nullptr;
+	UIElement* _focus = nullptr;
+	bool _globalDrawFlag = false;
+	bool _resolveFocusFlag = false;
+	bool _drawDeferred = false;
+	RowMask _dirtyRows = 0;
+	uint8_t _pendingRow = 0;
+	FocusToken _token;
+	PrinterBase* _printer = nullptr;
+	const Clock* _clock = &Clock::system();
+	Recorder* _recorder = nullptr;
+	UIContent* _rows[CRYSTALLINE_MAX_ROWS];
+	Array<UIContent*> _content;
+#ifdef CRYSTALLINE_PROFILING
+	FrameStats _frame;
+	FrameStats _lastFrame;
+	Histogram _frameMicros;
+#endif
+
+	void resolveFocus();
+	uint8_t getFocusRow();
+	void showCore(UILayout& overlay);
+	void hideCore();
+
+public:
+	uint8_t getWidth();
+	uint8_t getHeight();
+	PrinterBase* getPrinter();
+	const Clock& getClock() const;
+	void setClock(const Clock& clock);
+	void setRecorder(Recorder* recorder);
+	bool hasOverlay();
+	UILayout* getRoot();
+	UILayout* getOverlay();
+	UILayout* getCurrentView();
+	UIElement* getCurrentFocus();
+
+	void invalidateView();
+	void invalidateFocus();
+	void invalidateRows(RowMask rows);
+	bool hasDirtyRows(RowMask rows) const;
+	bool requestToken(const UIElement& element, FocusToken*& out);
+	bool isFocused(const UIElement& element);
+	void navigate(UILayout& root, bool reset = true);
+	void show(UILayout& overlay, bool reset = true);
+	void hide();
+	bool begin(PrinterBase* printer, UILayout& root);
+	void end();
+	bool update(uint32_t budgetMicros = 0);
+	void interact(const Interaction& interaction);
+	void draw(int row, UIContent& content);
+	DrawContext& draw(int draw);
+
+#ifdef CRYSTALLINE_PROFILING
+	FrameStats& getCurrentFrame();
+	const FrameStats& getLastFrame() const;
+	const Histogram& getFrameHistogram() const;
+	void resetProfile();
+#endif
+};
+
 class Crystalline
 {
 private:
-	static UILayout* _root;
-	static UILayout* _overlay;
-	static UIElement* _focus;
-	static bool _globalDrawFlag;
-	static bool _resolveFocusFlag;
-	static FocusToken _token;
-	static PrinterBase* _printer;
-	static Array<UIContent*> _content;
-
-	static void resolveFocus();
-	static void showCore(UILayout& overlay);
-	static void hideCore();
+	static UIContext _default;
 
 public:
+	static UIContext& getDefault();
 	static uint8_t getWidth();
 	static uint8_t getHeight();
+	static void setClock(const Clock& clock);
+	static void setRecorder(Recorder* recorder);
 	static bool hasOverlay();
 	static UILayout* getRoot();
 	static UILayout* getOverlay();
@@ -332,12 +621,18 @@ public:
 	static void navigate(UILayout& root, bool reset = true);
 	static void show(UILayout& overlay, bool reset = true);
 	static void hide();
-	static void begin(PrinterBase* printer, UILayout& root);
+	static bool begin(PrinterBase* printer, UILayout& root);
 	static void end();
-	static void update();
+	static bool update(uint32_t budgetMicros = 0);
 	static void interact(const Interaction& interaction);
 	static void draw(int row, UIContent& content);
 	static DrawContext& draw(int draw);
+
+#ifdef CRYSTALLINE_PROFILING
+	static const FrameStats& getLastFrame();
+	static const Histogram& getFrameHistogram();
+	static void resetProfile();
+#endif
 };
 
 #include "Panels.h"
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Arduino.h"
+
 template<typename T, typename ...TArgs>
 class Delegate;
 
@@ -9,6 +11,33 @@ using Function = T(*)(TArgs...);
 template<typename C, typename T, typename ...TArgs>
 using MemberFunction = T(C::*)(TArgs...);
 
+// The AVR toolchain ships without <type_traits> and <new>, so the little
+// InlineDelegate needs of them is spelled out here.
+namespace Traits
+{
+    template<bool Condition, typename T = void>
+    struct EnableIf { };
+
+    template<typename T>
+    struct EnableIf<true, T> { using Type = T; };
+
+    template<typename A, typename B>
+    struct IsSame { static const bool value = false; };
+
+    template<typename A>
+    struct IsSame<A, A> { static const bool value = true; };
+
+    template<typename T> struct Decay { using Type = T; };
+    template<typename T> struct Decay<const T> { using Type = typename Decay<T>::Type; };
+    template<typename T> struct Decay<volatile T> { using Type = typename Decay<T>::Type; };
+    template<typename T> struct Decay<T&> { using Type = typename Decay<T>::Type; };
+    template<typename T> struct Decay<T&&> { using Type = typename Decay<T>::Type; };
+
+    struct Placement { };
+}
+
+inline void* operator new(size_t, void* where, Traits::Placement) { return where; }
+
 namespace Invokers
 {
     template<typename T, typename ...TArgs>
@@ -193,6 +222,46 @@ public:
     virtual T get() = 0;
     virtual void set(T value) { }
     virtual bool isReadonly() { return true; }
+    virtual bool tryGetVersion(uint16_t& out) { return false; }
+};
+
+// Holds its value and counts changes, so readers can skip get() until the
+// version moves. Producers call set() when they sample, or touch() after
+// changing the value in place.
+template<typename T>
+class ObservableProperty : public Property<T>
+{
+private:
+    T _value;
+    uint16_t _version = 1;
+
+public:
+    ObservableProperty(T value = T()) : _value(value) { }
+
+    T get() override { return _value; }
+    void set(T value) override
+    {
+        if (_value == value)
+            return;
+        _value = value;
+        _version++;
+    }
+    bool isReadonly() override { return false; }
+    bool tryGetVersion(uint16_t& out) override
+    {
+        out = _version;
+        return true;
+    }
+
+    void touch() { _version++; }
+
+    ObservableProperty<T>& operator = (T value)
+    {
+        set(value);
+        return *this;
+    }
+
+    operator T() const { return _value; }
 };
 
 template<class T>
@@ -215,3 +284,161 @@ static Property<T>* propertyOf(const O& getter, const O& setter) { return Proper
 
 // template<class T>
 // static Property<T>* propertyOf(Getter<T> getter, Setter<T> setter) { return Property<T>::create(getter, setter); }
+
+// Value-type counterpart of Delegate. Function pointers, member function and
+// instance pairs, and small trivially copyable lambdas are stored inline and
+// called through a plain function pointer, so nothing is allocated and no
+// vtable is involved. An existing Delegate* converts implicitly.
+template<typename T, typename ...TArgs>
+class InlineDelegate
+{
+private:
+    struct Empty { void method() { } };
+
+    template<typename C>
+    struct Member
+    {
+        C* instance;
+        MemberFunction<C, T, TArgs...> function;
+    };
+
+    using Trampoline = T(*)(const InlineDelegate&, TArgs...);
+
+    static const uint8_t Size = sizeof(Member<Empty>);
+
+    alignas(Member<Empty>) uint8_t _storage[Size];
+    Trampoline _trampoline = nullptr;
+
+    // The callable is copy-constructed into the storage, so the storage
+    // holds a live object of its type and load() may read it back. Being
+    // trivially copyable, it also survives the byte-wise copy of the
+    // delegate itself.
+    template<typename S>
+    void store(const S& value)
+    {
+        static_assert(sizeof(S) <= Size, "Callable is too large to be stored inline.");
+        static_assert(alignof(S) <= alignof(Member<Empty>), "Callable is too strictly aligned to be stored inline.");
+        static_assert(__is_trivially_copyable(S), "Callable must be trivially copyable to be stored inline.");
+        new (_storage, Traits::Placement()) S(value);
+    }
+
+    template<typename S>
+    const S& load() const { return *reinterpret_cast<const S*>(_storage); }
+
+    static T invokeFunction(const InlineDelegate& d, TArgs... args) { return d.load<Function<T, TArgs...>>()(args...); }
+
+    template<typename C>
+    static T invokeMember(const InlineDelegate& d, TArgs... args)
+    {
+        auto& member = d.load<Member<C>>();
+        return (member.instance->*member.function)(args...);
+    }
+
+    template<typename O>
+    static T invokeObject(const InlineDelegate& d, TArgs... args) { return (T)d.load<O>()(args...); }
+
+    static T invokeDelegate(const InlineDelegate& d, TArgs... args) { return d.load<Delegate<T, TArgs...>*>()->invoke(args...); }
+
+public:
+    InlineDelegate() { }
+    InlineDelegate(decltype(nullptr)) { }
+
+    InlineDelegate(Function<T, TArgs...> function)
+    {
+        if (function == nullptr)
+            return;
+        store(function);
+        _trampoline = &invokeFunction;
+    }
+
+    template<typename C>
+    InlineDelegate(C& instance, MemberFunction<C, T, TArgs...> function)
+    {
+        store(Member<C>{ &instance, function });
+        _trampoline = &invokeMember<C>;
+    }
+
+    template<typename O, typename = typename Traits::EnableIf<!Traits::IsSame<typename Traits::Decay<O>::Type, InlineDelegate>::value>::Type>
+    InlineDelegate(const O& lambda)
+    {
+        store(lambda);
+        _trampoline = &invokeObject<O>;
+    }
+
+    InlineDelegate(Delegate<T, TArgs...>* delegate)
+    {
+        if (delegate == nullptr)
+            return;
+        store(delegate);
+        _trampoline = &invokeDelegate;
+    }
+
+    InlineDelegate(const InlineDelegate& other) = default;
+    InlineDelegate& operator = (const InlineDelegate& other) = default;
+
+    bool isEmpty() const { return _trampoline == nullptr; }
+    T invoke(TArgs... args) const { return _trampoline(*this, args...); }
+    T operator()(TArgs... args) const { return invoke(args...); }
+
+    bool operator == (decltype(nullptr)) const { return isEmpty(); }
+    bool operator != (decltype(nullptr)) const { return !isEmpty(); }
+
+    // Lets code written against Delegate* keep using handler->invoke().
+    const InlineDelegate* operator->() const { return this; }
+};
+
+template<typename T>
+using InlineGetter = InlineDelegate<T>;
+
+template<typename T>
+using InlineSetter = InlineDelegate<void, T>;
+
+using InlineAction = InlineDelegate<void>;
+
+// Value-type counterpart of Property, built from an inline getter and an
+// optional setter. An existing Property* converts implicitly and keeps its
+// virtual dispatch and version support.
+template<typename T>
+class InlineProperty
+{
+private:
+    Property<T>* _property = nullptr;
+    InlineGetter<T> _getter;
+    InlineSetter<T> _setter;
+
+public:
+    InlineProperty() { }
+    InlineProperty(decltype(nullptr)) { }
+    InlineProperty(Property<T>* property) : _property(property) { }
+    InlineProperty(InlineGetter<T> getter, InlineSetter<T> setter = nullptr) : _getter(getter), _setter(setter) { }
+
+    T get() { return _property != nullptr ? _property->get() : _getter(); }
+    void set(T value)
+    {
+        if (_property != nullptr)
+            _property->set(value);
+        else if (!_setter.isEmpty())
+            _setter(value);
+    }
+    bool isReadonly() const { return _property != nullptr ? _property->isReadonly() : _setter.isEmpty(); }
+    bool tryGetVersion(uint16_t& out) { return _property != nullptr && _property->tryGetVersion(out); }
+
+    bool isEmpty() const { return _property == nullptr && _getter.isEmpty(); }
+    Property<T>* getSource() const { return _property; }
+
+    bool operator == (decltype(nullptr)) const { return isEmpty(); }
+    bool operator != (decltype(nullptr)) const { return !isEmpty(); }
+
+    // Lets code written against Property* keep using content->get().
+    InlineProperty* operator->() { return this; }
+    const InlineProperty* operator->() const { return this; }
+};
+
+template<class T>
+static InlineProperty<T> inlinePropertyOf(Function<T> getter, Function<void, T> setter = nullptr) { return InlineProperty<T>(getter, setter); }
+
+template<class T, class C>
+static InlineProperty<T> inlinePropertyOf(C& instance, MemberFunction<C, T> getter) { return InlineProperty<T>(InlineGetter<T>(instance, getter)); }
+
+template<class T, class C>
+static InlineProperty<T> inlinePropertyOf(C& instance, MemberFunction<C, T> getter, MemberFunction<C, void, T> setter) { return InlineProperty<T>(InlineGetter<T>(instance, getter), InlineSetter<T>(instance, setter)); }
@@ -0,0 +1,95 @@
+#include "Formatting.h"
+
+#pragma region NumberFormatter
+
+uint32_t NumberFormatter::pow10(uint8_t exponent)
+{
+	uint32_t result = 1;
+	while (exponent-- > 0)
+		result *= 10;
+	return result;
+}
+
+uint8_t NumberFormatter::formatCore(char* buffer, uint32_t magnitude, bool isNegative, uint8_t scale, const NumberFormat& format)
+{
+	auto precision = format.precision;
+	if (scale > precision)
+	{
+		auto divisor = pow10(min(uint8_t(scale - precision), uint8_t(9)));
+		auto rest = magnitude % divisor;
+		magnitude = magnitude / divisor + (rest >= divisor - rest ? 1 : 0);
+		scale = precision;
+	}
+
+	// Digits are written backwards from the end of the buffer, starting with
+	// the zeros that pad the fraction up to the requested precision.
+	char digits[NumberFormat::Capacity];
+	uint8_t i = NumberFormat::Capacity;
+	uint8_t digit = 0;
+	isNegative = isNegative && magnitude > 0;
+
+	for (; digit < precision - scale; digit++)
+		digits[--i] = '0';
+
+	do
+	{
+		if (digit == precision && precision > 0)
+			digits[--i] = format.point;
+		else if (format.separator != '\0' && digit > precision && (digit - precision) % 3 == 0)
+			digits[--i] = format.separator;
+
+		digits[--i] = '0' + magnitude % 10;
+		magnitude /= 10;
+		digit++;
+	} while (magnitude > 0 || digit <= precision);
+
+	if (isNegative)
+		digits[--i] = '-';
+
+	uint8_t length = NumberFormat::Capacity - i;
+	memcpy(buffer, digits + i, length);
+	buffer[length] = '\0';
+	return length;
+}
+
+uint8_t NumberFormatter::format(char* buffer, float value, const NumberFormat& format)
+{
+	if (value != value)
+	{
+		strcpy(buffer, "nan");
+		return 3;
+	}
+
+	bool isNegative = value < 0.0f;
+	float scaled = (isNegative ? -value : value) * pow10(format.precision) + 0.5f;
+	if (scaled >= 4294967040.0f)
+	{
+		strcpy(buffer, "ovf");
+		return 3;
+	}
+	return formatCore(buffer, uint32_t(scaled), isNegative, format.precision, format);
+}
+
+uint8_t NumberFormatter::format(char* buffer, double value, const NumberFormat& format)
+{
+	return NumberFormatter::format(buffer, float(value), format);
+}
+
+float NumberFormatter::quantize(float value, const NumberFormat& format)
+{
+	bool isNegative = value < 0.0f;
+	float factor = pow10(format.precision);
+	float scaled = (isNegative ? -value : value) * factor + 0.5f;
+	if (!(scaled < 4294967040.0f))
+		return value;
+
+	float rounded = uint32_t(scaled) / factor;
+	return isNegative ? -rounded : rounded;
+}
+
+double NumberFormatter::quantize(double value, const NumberFormat& format)
+{
+	return NumberFormatter::quantize(float(value), format);
+}
+
+#pragma endregion
@@ -0,0 +1,113 @@
+#pragma once
+
+struct NumberFormat;
+template<class T> struct NumberTraits;
+class NumberFormatter;
+
+#include "Arduino.h"
+
+struct NumberFormat
+{
+	static const uint8_t Capacity = 24;
+	static const uint8_t MaxPrecision = 8;
+
+	// Digits after the point, and for integers how many of their digits are
+	// implied decimals (1234 with a scale of 2 is 12.34).
+	uint8_t precision;
+	uint8_t scale;
+	char separator;
+	char point;
+
+	NumberFormat(uint8_t precision = 0, uint8_t scale = 0, char separator = '\0', char point = '.') :
+		precision(min(precision, MaxPrecision)), scale(scale), separator(separator), point(point) { }
+};
+
+template<class T>
+struct NumberTraits
+{
+	static const uint8_t precision = 0;
+
+	static constexpr T step() { return T(1); }
+	static constexpr T minimum() { return T(-1) < T(0) ? T(uint64_t(1) << (sizeof(T) * 8 - 1)) : T(0); }
+	static constexpr T maximum() { return T(~minimum()); }
+};
+
+template<>
+struct NumberTraits<float>
+{
+	static const uint8_t precision = 1;
+
+	static constexpr float step() { return 0.1f; }
+	static constexpr float minimum() { return -3.4028235e38f; }
+	static constexpr float maximum() { return 3.4028235e38f; }
+};
+
+template<>
+struct NumberTraits<double>
+{
+	static const uint8_t precision = 1;
+
+	static constexpr double step() { return 0.1; }
+	static constexpr double minimum() { return -3.4028235e38; }
+	static constexpr double maximum() { return 3.4028235e38; }
+};
+
+// Renders numbers into a caller-provided buffer of at least
+// NumberFormat::Capacity characters without touching the heap.
+class NumberFormatter
+{
+private:
+	static uint32_t pow10(uint8_t exponent);
+	static uint8_t formatCore(char* buffer, uint32_t magnitude, bool isNegative, uint8_t scale, const NumberFormat& format);
+
+public:
+	template<class T>
+	static uint8_t format(char* buffer, T value, const NumberFormat& format)
+	{
+		bool isNegative = value < T(0);
+		uint32_t magnitude = isNegative ? uint32_t(0) - uint32_t(value) : uint32_t(value);
+		return formatCore(buffer, magnitude, isNegative, format.scale, format);
+	}
+
+	static uint8_t format(char* buffer, float value, const NumberFormat& format);
+	static uint8_t format(char* buffer, double value, const NumberFormat& format);
+
+	// Rounds a value to what format() would display, so two values that
+	// render the same compare equal.
+	template<class T>
+	static T quantize(T value, const NumberFormat& format)
+	{
+		if (format.scale <= format.precision)
+			return value;
+
+		bool isNegative = value < T(0);
+		uint32_t magnitude = isNegative ? uint32_t(0) - uint32_t(value) : uint32_t(value);
+		uint32_t divisor = pow10(min(uint8_t(format.scale - format.precision), uint8_t(9)));
+		uint32_t rest = magnitude % divisor;
+		magnitude -= rest;
+		if (rest >= divisor - rest)
+			magnitude += divisor;
+
+		// Values that would round past the range of T are left as they are.
+		T result = T(isNegative ? uint32_t(0) - magnitude : magnitude);
+		uint32_t check = isNegative ? uint32_t(0) - uint32_t(result) : uint32_t(result);
+		return check == magnitude ? result : value;
+	}
+
+	static float quantize(float value, const NumberFormat& format);
+	static double quantize(double value, const NumberFormat& format);
+
+	template<class T>
+	static T step(T value, int sign, T step, T minimum, T maximum)
+	{
+		if (value < minimum)
+			return minimum;
+		if (value > maximum)
+			return maximum;
+		if (sign > 0)
+			return value > maximum - step ? maximum : T(value + step);
+		if (sign < 0)
+			return value < minimum + step ? minimum : T(value - step);
+		return value;
+	}
+};
@@ -1,18 +1,18 @@
 #include "Panels.h"
 
-#pragma	region MenuLayout
+#pragma region PagedLayout
 
-void MenuLayout::onUpdate()
+void PagedLayout::onUpdate()
 {
 	handleUpdate(selectedPanel());
 }
 
-void MenuLayout::onDraw(Range rows)
+void PagedLayout::onDraw(Range rows)
 {
 	handleDraw(selectedPanel(), rows);
 }
 
-bool MenuLayout::onInteract(const Interaction& e)
+bool PagedLayout::onInteract(const Interaction& e)
 {
 	if (e.state == KeyState::Up)
 		return false;
@@ -31,42 +31,90 @@ bool MenuLayout::onInteract(const Interaction& e)
 	}
 }
 
-void MenuLayout::onReset()
+void PagedLayout::onReset()
 {
 	setSelection(0);
 }
 
-UIElement* MenuLayout::focusSource() const
+UIElement* PagedLayout::focusSource() const
 {
 	return _selection <= -1 ? nullptr : selectedPanel();
 }
 
-MenuLayout::MenuLayout() : MenuLayout(Array<MenuPanel*>())
+MenuPanel* PagedLayout::selectedPanel() const
 {
+	return getPanelCore(_selection);
 }
 
-MenuLayout::MenuLayout(Array<MenuPanel*> panels) : panels(panels), _selection(0)
+int8_t PagedLayout::getSelection() const
 {
+	return _selection;
 }
 
-MenuPanel* MenuLayout::selectedPanel() const
+void PagedLayout::setSelection(int8_t value)
 {
-	return panels[_selection];
+	if (value < 0)
+		value = getCountCore() - 1;
+	else if (value >= getCountCore())
+		value = 0;
+	if (invalidate(_selection, value, UIFlag::PropertyChanged))
+	{
+		selectCore(_selection);
+		handleFocus(true, true);
+	}
 }
 
-int8_t MenuLayout::getSelection() const
+#pragma endregion
+
+#pragma	region MenuLayout
+
+uint8_t MenuLayout::getCountCore() const
 {
-	return _selection;
+	return panels.length();
 }
 
-void MenuLayout::setSelection(int8_t value)
+MenuPanel* MenuLayout::getPanelCore(int8_t index) const
 {
-	if (value < 0)
-		value = panels.length() - 1;
-	else if (value >= panels.length())
-		value = 0;
-	if (invalidate(_selection, value, UIFlag::PropertyChanged))
-		handleFocus(true, true);
+	return panels[index];
+}
+
+bool MenuLayout::onInteract(const Interaction& e)
+{
+	if (PagedLayout::onInteract(e))
+		return true;
+
+	if (e.state == KeyState::Down && isSearchKey((int)e.key))
+	{
+		if (_index.getCount() != panels.length())
+			buildIndex();
+		auto match = _index.type((char)e.key, getContext().getClock().millis());
+		if (match >= 0)
+		{
+			setSelection(match);
+			return true;
+		}
+	}
+	return false;
+}
+
+MenuLayout::MenuLayout() : MenuLayout(Array<MenuPanel*>())
+{
+}
+
+MenuLayout::MenuLayout(Array<MenuPanel*> panels) : panels(panels)
+{
+	for (auto* panel : this->panels)
+		adopt(panel);
+}
+
+void MenuLayout::buildIndex()
+{
+	_index.build(panels.length(), [this](uint8_t i) { return panels[i]->getCaption(); });
+}
+
+const PrefixIndex& MenuLayout::getIndex() const
+{
+	return _index;
 }
 
 #pragma endregion
@@ -75,28 +123,44 @@ void MenuLayout::setSelection(int8_t value)
 
 void MenuPanel::onDrawHeader(DrawContext& context)
 {
-	context.fill(isFocused() ? 
-		(Glyphs::PointerDownLeft + header + Glyphs::PointerDownRight) : 
-		(Glyphs::PointerOverLeft + header + Glyphs::PointerOverRight), Alignment::Center);
+	if (isFocused())
+		context.fill(Glyphs::PointerDownLeft, header, Glyphs::PointerDownRight, Alignment::Center);
+	else
+		context.fill(Glyphs::PointerOverLeft, header, Glyphs::PointerOverRight, Alignment::Center);
 }
 
 void MenuPanel::onDrawContent(Range rows)
 {
-	for (uint8_t i = 0; i < rows.length(); i++)
-		Crystalline::draw(i).fill();
+	for (int i = rows.start; i <= rows.end; i++)
+		getContext().draw(i).fill();
 }
 
 void MenuPanel::onDraw(Range rows)
 {
+	// A panel visited only for its children leaves its own rows alone. The
+	// context redraws the rows the dirty children are on.
+	if (!isDirty(UIFlag::Own))
+		return;
 	if (isDirty(UIFlag::FocusChanged))
-		onDrawHeader(Crystalline::draw(rows.start));
+		onDrawHeader(getContext().draw(rows.start));
 	onDrawContent(rows.withMargin(1, 0));
 }
 
+TextSpan MenuPanel::getCaption() const
+{
+	return header;
+}
+
 #pragma endregion
 
 #pragma region ControlPanel
 
+void ControlPanel::onUpdate()
+{
+	if (binding != nullptr)
+		binding->refresh();
+}
+
 void ControlPanel::onReset()
 {
 	setSelection(-1);
@@ -127,9 +191,9 @@ void ControlPanel::onDrawContent(Range rows)
 	for (int i = rows.start, n = 0; i <= rows.end; i++)
 	{
 		if (_offset + n < controls.length())
-			Crystalline::draw(i, *controls[_offset + n++]);
+			getContext().draw(i, *(Control*)adopt(controls[_offset + n++]));
 		else
-			Crystalline::draw(i).fill();
+			getContext().draw(i).fill();
 	}
 }
 
@@ -142,7 +206,7 @@ bool ControlPanel::onInteract(const Interaction& e)
 	{
 	case KeyCode::Escape:
 		reset();
-		break;
+		return true;
 
 	case KeyCode::DownArrow:
 		setSelection(_selection + 1);
@@ -153,6 +217,19 @@ bool ControlPanel::onInteract(const Interaction& e)
 		return true;
 
 	default:
+		// Until a control is selected, search keys pick a panel in the
+		// MenuLayout instead.
+		if (_selection >= 0 && e.state == KeyState::Down && isSearchKey((int)e.key))
+		{
+			if (_index.getCount() != controls.length())
+				buildIndex();
+			auto match = _index.type((char)e.key, getContext().getClock().millis());
+			if (match >= 0)
+			{
+				setSelection(match);
+				return true;
+			}
+		}
 		return _selection >= 0;
 	}
 }
@@ -166,6 +243,8 @@ ControlPanel::ControlPanel(String header, Array<Control*> controls)
 	this->header = header;
 	this->controls = controls;
 	_selection = -1;
+	for (auto* control : this->controls)
+		adopt(control);
 }
 
 Control* ControlPanel::selectedControl() const
@@ -184,6 +263,168 @@ void ControlPanel::setSelection(int8_t value)
 		handleFocus();
 }
 
+void ControlPanel::buildIndex()
+{
+	_index.build(controls.length(), [this](uint8_t i) { return controls[i]->getCaption(); });
+}
+
+const PrefixIndex& ControlPanel::getIndex() const
+{
+	return _index;
+}
+
+#pragma endregion
+
+#pragma region VirtualPanel
+
+uint8_t VirtualPanel::getSlots() const
+{
+	return min(pool.length(), CRYSTALLINE_MAX_ROWS);
+}
+
+// Indices are signed so that -1 can mean no selection. Longer sources
+// show their first 32767 items.
+int16_t VirtualPanel::getLength() const
+{
+	return (int16_t)min(getCountCore(), (uint16_t)0x7FFF);
+}
+
+Control& VirtualPanel::materialize(int16_t index)
+{
+	auto slot = index % getSlots();
+	auto& control = *pool[slot];
+	if (_bound[slot] != index)
+	{
+		_bound[slot] = index;
+		bindCore(control, index);
+		control.invalidate(UIFlag::GlobalDraw);
+	}
+	return control;
+}
+
+uint16_t VirtualPanel::getCountCore() const
+{
+	return count != nullptr ? count->invoke() : 0;
+}
+
+void VirtualPanel::bindCore(Control& control, uint16_t index) const
+{
+	if (source != nullptr)
+		source->invoke(control, index);
+}
+
+void VirtualPanel::onReset()
+{
+	setSelection(-1);
+}
+
+UIElement* VirtualPanel::focusSource() const
+{
+	return selectedControl();
+}
+
+// Items are shown in at most as many rows as there are pool slots, so no
+// two visible items share a control. Rows beyond that are left blank.
+void VirtualPanel::onDrawContent(Range rows)
+{
+	auto visible = min(rows.length(), (int)getSlots());
+	auto s = max(_selection, (int16_t)0);
+	auto offset = _offset;
+
+	if (_offset > s)
+		offset = s;
+	else if (_offset + visible - 1 <= s)
+		offset = max(s - visible + 1, 0);
+
+	if (offset == _offset && !isDirty(UIFlag::GlobalDraw))
+		return;
+
+	_offset = offset;
+
+	auto length = getLength();
+	for (int i = rows.start, n = 0; i <= rows.end; i++, n++)
+	{
+		if (n < visible && _offset + n < length)
+			getContext().draw(i, materialize(_offset + n));
+		else
+			getContext().draw(i).fill();
+	}
+}
+
+bool VirtualPanel::onInteract(const Interaction& e)
+{
+	if (e.state == KeyState::Up)
+		return false;
+
+	switch (e.key)
+	{
+	case KeyCode::Escape:
+		reset();
+		return true;
+
+	case KeyCode::DownArrow:
+		setSelection(_selection + 1);
+		return true;
+
+	case KeyCode::UpArrow:
+		setSelection(_selection - 1);
+		return true;
+
+	default:
+		return _selection >= 0;
+	}
+}
+
+VirtualPanel::VirtualPanel() : VirtualPanel("", Array<Control*>(), nullptr, nullptr)
+{
+}
+
+VirtualPanel::VirtualPanel(String header, Array<Control*> pool, InlineGetter<uint16_t> count, InlineDelegate<void, Control&, uint16_t> source) :
+	pool(pool), count(count), source(source)
+{
+	this->header = header;
+	for (auto* control : this->pool)
+		adopt(control);
+	for (auto& bound : _bound)
+		bound = -1;
+}
+
+// Drops every binding, so items are fetched again on the next draw. Call it
+// when the source's items or count have changed.
+void VirtualPanel::refresh()
+{
+	for (auto& bound : _bound)
+		bound = -1;
+	if (_selection >= getLength())
+		setSelection(getLength() - 1);
+	else if (_selection >= 0 && getSlots() > 0)
+		materialize(_selection);
+	invalidate(UIFlag::GlobalDraw);
+}
+
+// The selected item is bound when it is selected, so this only looks it up.
+Control* VirtualPanel::selectedControl() const
+{
+	if (_selection < 0 || getSlots() == 0)
+		return nullptr;
+	return pool[_selection % getSlots()];
+}
+
+int16_t VirtualPanel::getSelection() const
+{
+	return _selection;
+}
+
+void VirtualPanel::setSelection(int16_t value)
+{
+	if (invalidate(_selection, (int16_t)clamp(value, (int16_t)-1, (int16_t)(getLength() - 1)), UIFlag::PropertyChanged))
+	{
+		if (_selection >= 0 && getSlots() > 0)
+			materialize(_selection);
+		handleFocus();
+	}
+}
+
 #pragma endregion
 
 #pragma region NavigationPanel
@@ -198,11 +439,11 @@ void NavigationPanel::onDrawContent(Range rows)
 {
 	auto body = rows.withLength(1, Alignment::Center);
 	for (int i = rows.start; i < body.end; i++)
-		Crystalline::draw(i).fill();
+		getContext().draw(i).fill();
 	for (int i = body.start; i <= body.end; i++)
-		Crystalline::draw(i).fill("...", Alignment::Center);
+		getContext().draw(i).fill(F("..."), Alignment::Center);
 	for (int i = body.end + 1; i <= rows.end; i++)
-		Crystalline::draw(i).fill();
+		getContext().draw(i).fill();
 }
 
 bool NavigationPanel::onInteract(const Interaction& e)
@@ -217,7 +458,7 @@ NavigationPanel::NavigationPanel() : NavigationPanel("", nullptr)
 {
 }
 
-NavigationPanel::NavigationPanel(String header, Action* handler)
+NavigationPanel::NavigationPanel(String header, InlineAction handler)
 {
 	this->header = header;
 	this->handler = handler;
@@ -1,27 +1,54 @@
 #pragma once
 
+class PagedLayout;
 class MenuLayout;
 class MenuPanel;
 class ControlPanel;
+class VirtualPanel;
 class NavigationPanel;
 
 #include "Arduino.h"
 #include "Array.h"
+#include "Bindings.h"
 #include "Delegate.h"
 #include "Controls.h"
+#include "Search.h"
 #include "Crystalline.h"
 
-class MenuLayout : public UILayout 
+// Shows one panel at a time and cycles through them with the left and
+// right arrows. Derived layouts say how many panels there are and where
+// they come from.
+class PagedLayout : public UILayout
 {
 private:
-	int8_t _selection;
+	int8_t _selection = 0;
 
 protected:
+	virtual uint8_t getCountCore() const = 0;
+	virtual MenuPanel* getPanelCore(int8_t index) const = 0;
+	virtual void selectCore(int8_t index) { }
+
 	void onUpdate() override;
 	void onDraw(Range rows) override;
 	bool onInteract(const Interaction& interaction) override;
 	void onReset() override;
 	UIElement* focusSource() const override;
+
+public:
+	MenuPanel* selectedPanel() const;
+	int8_t getSelection() const;
+	void setSelection(int8_t value);
+};
+
+class MenuLayout : public PagedLayout
+{
+private:
+	PrefixIndex _index;
+
+protected:
+	uint8_t getCountCore() const override;
+	MenuPanel* getPanelCore(int8_t index) const override;
+	bool onInteract(const Interaction& interaction) override;
 	
 public:
 	MenuLayout();
@@ -29,9 +56,8 @@ public:
 
 	Array<MenuPanel*> panels;
 
-	MenuPanel* selectedPanel() const;
-	int8_t getSelection() const;
-	void setSelection(int8_t value);
+	void buildIndex();
+	const PrefixIndex& getIndex() const;
 };
 
 class MenuPanel : public UILayout
@@ -43,6 +69,8 @@ protected:
 
 public:
 	String header;
+
+	virtual TextSpan getCaption() const;
 };
 
 class ControlPanel : public MenuPanel
@@ -50,8 +78,10 @@ class ControlPanel : public MenuPanel
 private:
 	int8_t _selection = -1;
 	int8_t _offset = 0;
+	PrefixIndex _index;
 
 protected:
+	void onUpdate() override;
 	void onReset() override;
 	UIElement* focusSource() const override;
 	void onDrawContent(Range rows) override;
@@ -62,11 +92,52 @@ public:
 	ControlPanel(String header, Array<Control*> controls);
 
 	Array<Control*> controls;
+	StructBinding* binding = nullptr;
 
 	Control* selectedControl() const;
 	int8_t getSelection() const;
 	void setSelection(int8_t value);
 
+	void buildIndex();
+	const PrefixIndex& getIndex() const;
+};
+
+// Shows count items through a recycled pool of controls. Item n is always
+// rendered by pool[n % pool.length()], which source binds when the item
+// scrolls into view. At most CRYSTALLINE_MAX_ROWS controls are used, and a
+// pool smaller than the panel shows items in only that many rows.
+class VirtualPanel : public MenuPanel
+{
+private:
+	int16_t _selection = -1;
+	int16_t _offset = 0;
+	int16_t _bound[CRYSTALLINE_MAX_ROWS];
+
+	uint8_t getSlots() const;
+	int16_t getLength() const;
+
+protected:
+	Control& materialize(int16_t index);
+	virtual uint16_t getCountCore() const;
+	virtual void bindCore(Control& control, uint16_t index) const;
+
+	void onReset() override;
+	UIElement* focusSource() const override;
+	void onDrawContent(Range rows) override;
+	bool onInteract(const Interaction& interaction) override;
+
+public:
+	VirtualPanel();
+	VirtualPanel(String header, Array<Control*> pool, InlineGetter<uint16_t> count, InlineDelegate<void, Control&, uint16_t> source);
+
+	Array<Control*> pool;
+	InlineGetter<uint16_t> count;
+	InlineDelegate<void, Control&, uint16_t> source;
+
+	void refresh();
+	Control* selectedControl() const;
+	int16_t getSelection() const;
+	void setSelection(int16_t value);
 };
 
 class NavigationPanel : public MenuPanel
@@ -78,7 +149,7 @@ protected:
 
 public:
 	NavigationPanel();
-	NavigationPanel(String header, Action* handler);
+	NavigationPanel(String header, InlineAction handler);
 
-	Action* handler;
+	InlineAction handler;
 };
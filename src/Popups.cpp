@@ -14,7 +14,7 @@ void PopupLayout::onDraw(Range rows)
 		{
 			for (int i = rows.start; i <= rows.end; i++)
 			{
-				auto& context = Crystalline::draw(i);
+				auto& context = getContext().draw(i);
 				if (i == max(rows.length() / 2 - 1, 0))
 					context.fill(header, Alignment::Center);
 				else if (i == max(rows.length() / 2, 1))
@@ -27,12 +27,12 @@ void PopupLayout::onDraw(Range rows)
 		}
 		else if (rows.length() >= 2)
 		{
-			Crystalline::draw(rows.start).fill(header, Alignment::Center);
-			onDrawContent(Crystalline::draw(rows.end));
+			getContext().draw(rows.start).fill(header, Alignment::Center);
+			onDrawContent(getContext().draw(rows.end));
 		}
 		else
 		{
-			auto& context = Crystalline::draw(rows.start);
+			auto& context = getContext().draw(rows.start);
 			context.write(header);
 			context.write(' ');
 			onDrawContent(context);
@@ -41,12 +41,12 @@ void PopupLayout::onDraw(Range rows)
 	else
 	{
 		if (rows.length() >= 4)
-			onDrawContent(Crystalline::draw(max(rows.length() / 2, 1)));
+			onDrawContent(getContext().draw(max(rows.length() / 2, 1)));
 		else if (rows.length() >= 2)
-			onDrawContent(Crystalline::draw(rows.end));
+			onDrawContent(getContext().draw(rows.end));
 		else
 		{
-			auto& context = Crystalline::draw(rows.start);
+			auto& context = getContext().draw(rows.start);
 			context.omit(header.length() + 1, true);
 			onDrawContent(context);
 		}
@@ -140,8 +140,8 @@ bool DialogPopup::onClose()
 void DialogPopup::onDrawContent(DrawContext& context)
 {
 	FocusToken* token;
-	String s = Glyphs::PointerDownLeft + (requestToken(token) && token->state == FocusState::Pressed ? " Yes " : " No ") + Glyphs::PointerDownRight;
-	context.fill(s, Alignment::Center);
+	bool isPressed = requestToken(token) && token->state == FocusState::Pressed;
+	context.fill(Glyphs::PointerDownLeft, isPressed ? F(" Yes ") : F(" No "), Glyphs::PointerDownRight, Alignment::Center);
 }
 
 DialogPopup::DialogPopup(String header, PopupHandler<bool>* handler, int8_t priority) :
@@ -236,11 +236,14 @@ bool ProgressPopup::onInteract(const Interaction& interaction)
 
 void ProgressPopup::onUpdate()
 {
-	invalidate(_last, source->invoke(), UIFlag::PropertyChanged);
+	CRYSTALLINE_PROFILE(getContext().getCurrentFrame().reads++);
+	_last = source->invoke();
+	if (_bar.hasChanged(_last, _cells))
+		invalidate(UIFlag::PropertyChanged);
+
 	FocusToken* token;
 	if (requestToken(token))
 	{
-		Serial.println(_last);
 		if (_last < 1.0f)
 			token->timer.reset();
 		else if (token->timer.hasElapsed(1000))
@@ -252,19 +255,16 @@ bool ProgressPopup::onClose() { return true; }
 
 void ProgressPopup::onDrawContent(DrawContext& context)
 {
-	int threshold = context.getRemaining() * source->invoke();
-	context.repeat(Glyphs::LoadingBar, threshold);
-	context.fill();
+	_cells = context.getRemaining();
+	_bar.draw(context, _last, _cells, isDirty(UIFlag::FocusChanged));
 }
 
-ProgressPopup::ProgressPopup(String header, Getter<float>* source, int8_t priority = 0) : source(source), PopupLayout(header, priority) { }
+ProgressPopup::ProgressPopup(String header, InlineGetter<float> source, int8_t priority = 0) : source(source), PopupLayout(header, priority) { }
 
 #pragma endregion
 
 #pragma region PopupManager
 
-Array<PopupLayout*> PopupManager::_popups = Array<PopupLayout*>::ofSize(8, nullptr);
-
-PopupLayout* PopupManager::_current = nullptr;
+Array<PopupManager::Entry> PopupManager::_popups = Array<PopupManager::Entry>::ofSize(8, PopupManager::Entry{ nullptr, nullptr });
 
 #pragma endregion
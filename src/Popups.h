@@ -77,82 +77,94 @@ public:
 class ProgressPopup : public PopupLayout
 {
 	float _last;
+	uint8_t _cells = 0;
+	BarRenderer _bar;
 	bool onInteract(const Interaction& interaction) override;
 	bool onClose() override;
 	void onDrawContent(DrawContext& context) override;
 	void onUpdate() override;
 
 public:
-	Getter<float>* source;
-	ProgressPopup(String header, Getter<float>* source, int8_t priority = 0);
+	InlineGetter<float> source;
+	ProgressPopup(String header, InlineGetter<float> source, int8_t priority = 0);
 };
 
+// Popups are stacked per context: showing one on a context only competes
+// with the other popups shown on that context.
 class PopupManager 
 {
 private:
-	static Array<PopupLayout*> _popups;
-	static PopupLayout* _current;
+	struct Entry
+	{
+		PopupLayout* popup;
+		UIContext* context;
+	};
+
+	static Array<Entry> _popups;
 
 public:
 	static bool isOpen(PopupLayout& layout)
 	{
-		for (auto& popup : _popups)
-			if (popup == &layout)
+		for (auto& entry : _popups)
+			if (entry.popup == &layout)
 				return true;
 		return false;
 	}
 
-	static bool show(PopupLayout& popup)
+	static bool show(PopupLayout& popup, UIContext& context = Crystalline::getDefault())
 	{
-		PopupLayout** insert = nullptr;
+		Entry* insert = nullptr;
 		PopupLayout* top = &popup;
-		for (auto& p : _popups)
+		for (auto& entry : _popups)
 		{
-			if (p == &popup)
+			if (entry.popup == &popup)
 				return false;
 
-			if (p == nullptr)
-				insert = &p;
-			else if (top->priority <= p->priority)
-				top = p;
+			if (entry.popup == nullptr)
+				insert = &entry;
+			else if (entry.context == &context && top->priority <= entry.popup->priority)
+				top = entry.popup;
 		}
 
 		if (insert == nullptr)
 			return false;
 		else
-			(*insert) = &popup;
+			(*insert) = Entry{ &popup, &context };
 
+		popup._context = &context;
 		popup.reset();
 
-		_current = top;
-		
-		Crystalline::show(*_current, false);
+		context.show(*top, false);
 		
 		return true;
 	}
 
 	static bool hide(PopupLayout& popup)
 	{
-		PopupLayout** insert = nullptr;
+		Entry* insert = nullptr;
+		for (auto& entry : _popups)
+			if (entry.popup == &popup)
+				insert = &entry;
+
+		if (insert == nullptr)
+			return true;
+
+		auto& context = *insert->context;
+		(*insert) = Entry{ nullptr, nullptr };
+
 		PopupLayout* top = nullptr;
-		for (auto& p : _popups)
+		for (auto& entry : _popups)
+			if (entry.popup != nullptr && entry.context == &context && (top == nullptr || entry.popup->priority >= top->priority))
+				top = entry.popup;
+
+		if (context.getOverlay() == &popup)
 		{
-			if (p == &popup)
-				insert = &p;
-			else if (top == nullptr || p != nullptr && p->priority >= top->priority)
-				top = p;
+			if (top != nullptr)
+				context.show(*top, false);
+			else
+				context.hide();
 		}
 
-		if (insert != nullptr)
-			(*insert) = nullptr;
-
-		if (top != nullptr && Crystalline::getOverlay() == _current)
-			Crystalline::show(*top, false);
-		else if (Crystalline::getOverlay() == &popup)
-			Crystalline::hide();
-		
-		_current = top;
-
 		return true;
 	}
 };
@@ -2,18 +2,152 @@
 
 #pragma region PrinterBase
 
-PrinterBase::PrinterBase(uint8_t width, uint8_t height) : width(width), height(height)
+PrinterBase::PrinterBase(uint8_t width, uint8_t height, uint8_t moveCost, uint8_t printCost) :
+	width(width), height(height), moveCost(moveCost), printCost(printCost)
 {
-	posX = virtualX = width;
-	posY = virtualY = height;
+	_buffer = new char[width * height];
+	_frame = new char[width * height];
+	_known = new uint8_t[(width * height + 7) / 8];
+	_dirtyStart = new uint8_t[height];
+	_dirtyEnd = new uint8_t[height];
+	memset(_frame, Glyphs::DefaultPadding, width * height);
+	invalidate();
 }
 
-void PrinterBase::print(char c)
+PrinterBase::~PrinterBase()
+{
+	delete[] _buffer;
+	delete[] _frame;
+	delete[] _known;
+	delete[] _dirtyStart;
+	delete[] _dirtyEnd;
+	delete[] _glyphs;
+	_glyphs = nullptr;
+	_buffer = _frame = nullptr;
+	_known = _dirtyStart = _dirtyEnd = nullptr;
+}
+
+bool PrinterBase::isKnown(uint16_t cell) const
+{
+	return _known[cell / 8] & (1 << (cell % 8));
+}
+
+bool PrinterBase::isChanged(uint16_t cell) const
 {
-	if (printCore(c))
+	return !isKnown(cell) || _buffer[cell] != _frame[cell];
+}
+
+bool PrinterBase::flushRow(uint8_t y, const Budget& budget)
+{
+	auto row = y * width;
+	auto end = _dirtyEnd[y];
+	auto x = _dirtyStart[y];
+
+	while (x <= end)
 	{
+		while (x <= end && !isChanged(row + x))
+			x++;
+		if (x > end)
+			break;
+
+		// Grow the span over unchanged gaps as long as rewriting them is
+		// cheaper than the cursor command needed to jump across.
+		auto start = x;
+		auto last = x;
+		while (++x <= end)
+		{
+			if (!isChanged(row + x))
+				continue;
+			if ((x - last - 1) * printCost > moveCost)
+				break;
+			if (x - last > 1)
+				_stats.merged++;
+			last = x;
+		}
+
+		auto capacity = getCapacity();
+		if (capacity == 0)
+			return false;
+		if (last - start >= capacity)
+			last = start + capacity - 1;
+
+		// A refused move or print leaves the rest of the row dirty.
+		if (!flushSpan(y, start, last))
+			return false;
+
+		x = last + 1;
+		_dirtyStart[y] = x;
+
+		if (x <= end && budget.isSpent())
+			return false;
+	}
+
+	_dirtyStart[y] = width;
+	_dirtyEnd[y] = 0;
+	return true;
+}
+
+bool PrinterBase::flushSpan(uint8_t y, uint8_t start, uint8_t end)
+{
+	if ((posX != start || posY != y) && !move(start, y))
+		return false;
+
+	for (auto x = start; x <= end; x++)
+	{
+		uint16_t cell = y * width + x;
+		if (!isChanged(cell))
+			_stats.bridged++;
+
+		// Whatever could not be sent stays dirty for the next flush.
+		if (!printCore(_frame[cell]))
+		{
+			_dirtyStart[y] = x;
+			posX = width;
+			posY = height;
+			return false;
+		}
+
+		_buffer[cell] = _frame[cell];
+		_known[cell / 8] |= 1 << (cell % 8);
+		_stats.written++;
+		_revision++;
 		posX++;
-		virtualX++;
+	}
+	return true;
+}
+
+void PrinterBase::print(char c)
+{
+	if (virtualX >= width || virtualY >= height)
+		return;
+
+	uint16_t cell = virtualY * width + virtualX;
+	_frame[cell] = c;
+	virtualX++;
+
+	if (!isChanged(cell))
+	{
+		_stats.skipped++;
+		return;
+	}
+
+	_dirtyStart[virtualY] = min(_dirtyStart[virtualY], uint8_t(virtualX - 1));
+	_dirtyEnd[virtualY] = max(_dirtyEnd[virtualY], uint8_t(virtualX - 1));
+}
+
+uint8_t PrinterBase::align(uint8_t length, Alignment alignment, uint8_t total) const
+{
+	if (length >= total)
+		return 0;
+
+	switch (alignment)
+	{
+	case Alignment::Center:
+		return (total - length) / 2;
+	case Alignment::Back:
+		return total - length;
+	default:
+		return 0;
 	}
 }
 
@@ -28,6 +162,7 @@ bool PrinterBase::move(uint8_t x, uint8_t y)
 {
 	if (moveCore(x, y))
 	{
+		_stats.moves++;
 		posX = x;
 		posY = y;
 		return true;
@@ -46,6 +181,88 @@ void PrinterBase::virtualMove(uint8_t x, uint8_t y)
 	virtualY = y;
 }
 
+const PrintStats& PrinterBase::getStats() const
+{
+	return _lastStats;
+}
+
+// Counts of the flush still in progress, when the last one ran out of
+// budget or capacity.
+const PrintStats& PrinterBase::getPendingStats() const
+{
+	return _stats;
+}
+
+uint32_t PrinterBase::getRevision() const
+{
+	return _revision;
+}
+
+RowMask PrinterBase::getEvictedRows() const
+{
+	return _evictedRows;
+}
+
+void PrinterBase::clearEvictedRows()
+{
+	_evictedRows = 0;
+}
+
+const uint8_t* PrinterBase::getGlyphBitmap(uint8_t slot) const
+{
+	return _glyphs != nullptr && slot < GlyphSlots ? _glyphs[slot].bitmap : nullptr;
+}
+
+void PrinterBase::invalidate()
+{
+	memset(_known, 0, (width * height + 7) / 8);
+	memset(_dirtyStart, 0, height);
+	memset(_dirtyEnd, width - 1, height);
+	posX = virtualX = width;
+	posY = virtualY = height;
+}
+
+// Forgets what a span of cells shows, so the next flush repaints them.
+void PrinterBase::invalidate(uint8_t x, uint8_t y, uint8_t length)
+{
+	if (y >= height || x >= width || length == 0)
+		return;
+
+	uint8_t last = min(uint16_t(x + length - 1), uint16_t(width - 1));
+	for (uint16_t cell = y * width + x; cell <= y * width + last; cell++)
+		_known[cell / 8] &= ~(1 << (cell % 8));
+	_dirtyStart[y] = min(_dirtyStart[y], x);
+	_dirtyEnd[y] = max(_dirtyEnd[y], last);
+}
+
+bool PrinterBase::flush(uint32_t budgetMicros, uint8_t firstRow)
+{
+	auto budget = Budget(budgetMicros);
+
+	// The first row goes ahead, the others continue where the last
+	// interrupted flush stopped so no row starves under a tight budget.
+	for (uint8_t n = 0; n <= height; n++)
+	{
+		uint8_t y = n == 0 ? firstRow : (_resumeRow + n - 1) % height;
+		if (y >= height || (n > 0 && y == firstRow))
+			continue;
+
+		if (_dirtyStart[y] > _dirtyEnd[y])
+			continue;
+
+		if ((n > 0 && budget.isSpent()) || !flushRow(y, budget))
+		{
+			_resumeRow = y;
+			return false;
+		}
+	}
+
+	_lastStats = _stats;
+	_stats = PrintStats();
+	_glyphClock++;
+	return true;
+}
+
 uint8_t PrinterBase::getRemaining() const
 {
 	return getTotal() - getPosition();
@@ -69,83 +286,72 @@ DrawContext* PrinterBase::begin(int row)
 
 void PrinterBase::write(char c)
 {
-	if (!ensureMove())
-		return;
 	print(c);
 }
 
-void PrinterBase::write(String s)
+void PrinterBase::writeSpan(const char* s, uint8_t length)
 {
-	if (!ensureMove())
-		return;
-	for (int i = 0; i < s.length(); i++)
+	for (uint8_t i = 0; i < length; i++)
 		print(s[i]);
 }
 
-void PrinterBase::write(String s, Alignment alignment, uint8_t total, char padding)
+void PrinterBase::write(TextSpan s)
 {
-	if (!ensureMove())
-		return;
-
-	uint8_t start = 0;
-	uint8_t end = total;
-
-	switch (alignment)
+	if (!s.isFlash)
 	{
-	case Alignment::Back:
-		start = total - s.length();
-		break;
-	case Alignment::Front:
-		end = s.length();
-		break;
-	case Alignment::Center:
-		start = max(uint8_t((total - s.length()) / 2), 0);
-		end = min(uint8_t(start + s.length()), total);
-		break;
+		writeSpan(s.data, s.length);
+		return;
 	}
+	for (uint8_t i = 0; i < s.length; i++)
+		print(s[i]);
+}
 
-	for (int i = 0; i < total; i++)
-	{
-		if (i < start || i >= end)
-			print(padding);
-		else
-			print(s[i - start]);
-	}
+void PrinterBase::write(TextSpan s, Alignment alignment, uint8_t total, char padding)
+{
+	auto length = min(s.length, total);
+	auto start = align(length, alignment, total);
+
+	repeat(padding, start);
+	write(TextSpan(s.data, length, s.isFlash));
+	repeat(padding, total - start - length);
 }
 
 void PrinterBase::fill(char c)
 {
-	if (!ensureMove())
-		return;
 	repeat(c, getRemaining());
 }
 
 void PrinterBase::fill(char prefix, char infix, char postfix)
 {
-	if (!ensureMove())
-		return;
 	repeat(prefix, infix, postfix, getRemaining());
 }
 
-void PrinterBase::fill(String s, Alignment aligment, char padding)
+void PrinterBase::fill(TextSpan s, Alignment aligment, char padding)
 {
-	if (!ensureMove())
-		return;
 	write(s, aligment, getRemaining(), padding);
 }
 
+void PrinterBase::fill(char prefix, TextSpan s, char postfix, Alignment alignment, char padding)
+{
+	auto total = getRemaining();
+	auto length = min(s.length, uint8_t(max(total - 2, 0)));
+	auto start = align(length + 2, alignment, total);
+
+	repeat(padding, start);
+	print(prefix);
+	write(TextSpan(s.data, length, s.isFlash));
+	print(postfix);
+	fill(padding);
+}
+
 void PrinterBase::repeat(char c, uint8_t count)
 {
-	if (!ensureMove())
-		return;
 	for (int i = 0; i < count; i++)
 		print(c);
 }
 
 void PrinterBase::repeat(char prefix, char infix, char postfix, uint8_t count)
 {
-	if (!ensureMove())
-		return;
 	print(prefix);
 	for (int i = 0; i < count - 2; i++)
 		print(infix);
@@ -161,4 +367,65 @@ bool PrinterBase::omit(uint8_t count, bool check)
 	return false;
 }
 
+char PrinterBase::glyph(uint8_t id, const uint8_t* bitmap, char fallback)
+{
+	if (_glyphs == nullptr)
+		_glyphs = new GlyphSlot[GlyphSlots];
+
+	GlyphSlot* slot = nullptr;
+	for (uint8_t i = 0; i < GlyphSlots; i++)
+	{
+		auto& candidate = _glyphs[i];
+		if (candidate.isDefined && candidate.id == id)
+		{
+			slot = &candidate;
+			break;
+		}
+
+		// Prefer empty slots, then the one that has gone unused the longest.
+		// Slots requested during the current frame are never evicted.
+		if (candidate.isDefined && candidate.used == _glyphClock)
+			continue;
+		if (slot == nullptr || (slot->isDefined && (!candidate.isDefined || uint16_t(_glyphClock - candidate.used) > uint16_t(_glyphClock - slot->used))))
+			slot = &candidate;
+	}
+
+	if (slot == nullptr)
+		return fallback;
+
+	uint8_t index = slot - _glyphs;
+	char code = GlyphSlots + index;
+
+	if (!slot->isDefined || slot->id != id || memcmp(slot->bitmap, bitmap, sizeof(slot->bitmap)) != 0)
+	{
+		// Cells still showing the old glyph change with the slot. They are
+		// repainted, and their rows reported so whoever drew them can ask
+		// for their glyph again before the flush.
+		if (slot->isDefined && slot->id != id)
+		{
+			for (uint16_t cell = 0; cell < width * height; cell++)
+			{
+				if (_frame[cell] != code && _frame[cell] != index)
+					continue;
+				invalidate(cell % width, cell / width, 1);
+				_evictedRows |= rowMaskOf(cell / width);
+			}
+		}
+
+		slot->isDefined = false;
+		slot->id = id;
+		memcpy(slot->bitmap, bitmap, sizeof(slot->bitmap));
+		if (!defineCore(index, slot->bitmap))
+			return fallback;
+
+		// Writing CGRAM moves the display's address counter.
+		posX = width;
+		posY = height;
+		slot->isDefined = true;
+	}
+
+	slot->used = _glyphClock;
+	return code;
+}
+
 #pragma endregion
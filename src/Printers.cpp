@@ -0,0 +1,202 @@
+#include "Printers.h"
+
+#pragma region QueuedPrinter
+
+QueuedPrinter::QueuedPrinter(uint8_t width, uint8_t height, uint8_t capacity, uint8_t moveCost, uint8_t printCost) :
+	PrinterBase(width, height, moveCost, printCost), _size(capacity + 1)
+{
+	_queue = new Command[_size];
+	_queueX = _busX = width;
+	_queueY = _busY = height;
+}
+
+QueuedPrinter::~QueuedPrinter()
+{
+	delete[] _queue;
+	_queue = nullptr;
+}
+
+uint8_t QueuedPrinter::next(uint8_t index) const
+{
+	return index + 1 < _size ? index + 1 : 0;
+}
+
+bool QueuedPrinter::printCore(char c)
+{
+	if (_queueX >= width || _queueY >= height)
+		return false;
+
+	// A pending write to the same cell is superseded in place. Interrupts
+	// are held off so a pump() from a completion handler can't send the
+	// entry while it is being replaced.
+	noInterrupts();
+	for (auto i = _head; i != _tail; i = next(i))
+	{
+		auto& command = _queue[i];
+		if (command.x == _queueX && command.y == _queueY)
+		{
+			command.c = c;
+			interrupts();
+			_queueX++;
+			return true;
+		}
+	}
+	interrupts();
+
+	if (next(_tail) == _head)
+		return false;
+
+	_queue[_tail] = Command{ _queueX++, _queueY, c };
+	_tail = next(_tail);
+	return true;
+}
+
+bool QueuedPrinter::moveCore(uint8_t x, uint8_t y)
+{
+	if (x >= width || y >= height)
+		return false;
+	_queueX = x;
+	_queueY = y;
+	return true;
+}
+
+uint8_t QueuedPrinter::getCapacity() const
+{
+	return _size - 1 - getPending();
+}
+
+bool QueuedPrinter::defineCore(uint8_t slot, const uint8_t* bitmap)
+{
+	// Without glyph support the caller falls back before anything is queued.
+	if (!hasGlyphs())
+		return false;
+
+	noInterrupts();
+	_pendingGlyphs |= 1 << slot;
+	interrupts();
+	return true;
+}
+
+uint8_t QueuedPrinter::getPending() const
+{
+	uint8_t head = _head;
+	uint8_t tail = _tail;
+	return tail >= head ? tail - head : _size - head + tail;
+}
+
+uint8_t QueuedPrinter::pump(uint8_t count)
+{
+	uint8_t sent = 0;
+
+	// Glyph uploads go first so queued cells show the new bitmap.
+	for (uint8_t slot = 0; slot < 8 && _pendingGlyphs != 0 && sent < count && !isBusy(); slot++)
+	{
+		if ((_pendingGlyphs & (1 << slot)) == 0)
+			continue;
+		_busX = width;
+		_busY = height;
+
+		// A refused upload stays pending and holds back the cells that
+		// would show it until it goes through.
+		if (!sendDefineCore(slot, getGlyphBitmap(slot)))
+			return sent;
+		_pendingGlyphs &= ~(1 << slot);
+		sent++;
+	}
+
+	while (sent < count && _head != _tail && !isBusy())
+	{
+		auto command = _queue[_head];
+		_head = next(_head);
+
+		// The shadow already counts a queued cell as shown, so a cell the
+		// bus refused is forgotten and repainted by the next flush.
+		if (command.x != _busX || command.y != _busY)
+		{
+			if (!sendMoveCore(command.x, command.y))
+			{
+				_busX = width;
+				_busY = height;
+				invalidate(command.x, command.y, 1);
+				continue;
+			}
+			_busX = command.x;
+			_busY = command.y;
+		}
+
+		if (!sendPrintCore(command.c))
+		{
+			_busX = width;
+			invalidate(command.x, command.y, 1);
+			continue;
+		}
+		_busX++;
+		sent++;
+	}
+	return sent;
+}
+
+#pragma endregion
+
+#pragma region SimulatedPrinter
+
+SimulatedPrinter::SimulatedPrinter(uint8_t width, uint8_t height, uint16_t byteMicros, uint8_t moveCost, uint8_t printCost) :
+	PrinterBase(width, height, moveCost, printCost), byteMicros(byteMicros)
+{
+	_glass = new char[width * height];
+	memset(_glass, ' ', width * height);
+}
+
+SimulatedPrinter::~SimulatedPrinter()
+{
+	delete[] _glass;
+	_glass = nullptr;
+}
+
+bool SimulatedPrinter::printCore(char c)
+{
+	if (_cursorX >= width || _cursorY >= height)
+		return false;
+	_glass[_cursorY * width + _cursorX++] = c;
+	_bus.bytes++;
+	_bus.micros += byteMicros;
+	return true;
+}
+
+bool SimulatedPrinter::moveCore(uint8_t x, uint8_t y)
+{
+	if (x >= width || y >= height)
+		return false;
+	_cursorX = x;
+	_cursorY = y;
+	_bus.commands++;
+	_bus.micros += byteMicros;
+	return true;
+}
+
+bool SimulatedPrinter::defineCore(uint8_t slot, const uint8_t* bitmap)
+{
+	// One set-CGRAM-address command followed by the eight rows.
+	_bus.uploads++;
+	_bus.commands++;
+	_bus.bytes += 8;
+	_bus.micros += 9 * byteMicros;
+	return true;
+}
+
+char SimulatedPrinter::getCell(uint8_t x, uint8_t y) const
+{
+	return x < width && y < height ? _glass[y * width + x] : '\0';
+}
+
+const BusStats& SimulatedPrinter::getBusStats() const
+{
+	return _bus;
+}
+
+void SimulatedPrinter::resetBusStats()
+{
+	_bus = BusStats();
+}
+
+#pragma endregion
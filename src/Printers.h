@@ -0,0 +1,80 @@
+#pragma once
+
+class QueuedPrinter;
+class SimulatedPrinter;
+
+#include "Arduino.h"
+#include "Crystalline.h"
+
+class QueuedPrinter : public PrinterBase
+{
+private:
+	struct Command
+	{
+		uint8_t x;
+		uint8_t y;
+		char c;
+	};
+
+	Command* _queue;
+	const uint8_t _size;
+	volatile uint8_t _head = 0;
+	volatile uint8_t _tail = 0;
+	volatile uint8_t _pendingGlyphs = 0;
+	uint8_t _queueX, _queueY;
+	uint8_t _busX, _busY;
+
+	uint8_t next(uint8_t index) const;
+
+protected:
+	QueuedPrinter(uint8_t width, uint8_t height, uint8_t capacity = 32, uint8_t moveCost = 1, uint8_t printCost = 1);
+
+	bool printCore(char c) override;
+	bool moveCore(uint8_t x, uint8_t y) override;
+	uint8_t getCapacity() const override;
+	bool defineCore(uint8_t slot, const uint8_t* bitmap) override;
+
+	virtual bool isBusy() { return false; }
+	virtual bool hasGlyphs() { return false; }
+	virtual bool sendPrintCore(char c) = 0;
+	virtual bool sendMoveCore(uint8_t x, uint8_t y) = 0;
+	virtual bool sendDefineCore(uint8_t slot, const uint8_t* bitmap) { return false; }
+
+public:
+	~QueuedPrinter();
+
+	uint8_t getPending() const;
+	uint8_t pump(uint8_t count = 255);
+};
+
+struct BusStats
+{
+	uint32_t bytes = 0;
+	uint32_t commands = 0;
+	uint32_t uploads = 0;
+	uint32_t micros = 0;
+};
+
+class SimulatedPrinter : public PrinterBase
+{
+private:
+	char* _glass;
+	uint8_t _cursorX = 0;
+	uint8_t _cursorY = 0;
+	BusStats _bus;
+
+protected:
+	bool printCore(char c) override;
+	bool moveCore(uint8_t x, uint8_t y) override;
+	bool defineCore(uint8_t slot, const uint8_t* bitmap) override;
+
+public:
+	SimulatedPrinter(uint8_t width, uint8_t height, uint16_t byteMicros = 100, uint8_t moveCost = 1, uint8_t printCost = 1);
+	~SimulatedPrinter();
+
+	const uint16_t byteMicros;
+
+	char getCell(uint8_t x, uint8_t y) const;
+	const BusStats& getBusStats() const;
+	void resetBusStats();
+};
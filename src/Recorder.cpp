@@ -0,0 +1,212 @@
+#include "Recorder.h"
+
+#pragma region Recorder
+
+Recorder::Recorder(uint8_t* buffer, uint16_t capacity) : _buffer(buffer), _capacity(capacity)
+{
+}
+
+void Recorder::record(uint8_t tag, int16_t key, uint32_t timestamp)
+{
+	if (_isFull)
+		return;
+
+	uint32_t delta = _isStarted ? timestamp - _last : 0;
+	uint8_t size = key >= 0 ? 3 : 2;
+	for (auto rest = delta >> 7; rest != 0; rest >>= 7)
+		size++;
+
+	if (_length + size > _capacity)
+	{
+		_isFull = true;
+		return;
+	}
+
+	_buffer[_length++] = tag;
+	if (key >= 0)
+		_buffer[_length++] = (uint8_t)key;
+	while (delta >= 0x80)
+	{
+		_buffer[_length++] = 0x80 | (delta & 0x7F);
+		delta >>= 7;
+	}
+	_buffer[_length++] = delta;
+
+	_last = timestamp;
+	_isStarted = true;
+}
+
+void Recorder::frame(uint32_t timestamp)
+{
+	record(FrameTag, -1, timestamp);
+}
+
+void Recorder::interaction(const Interaction& interaction, uint32_t timestamp)
+{
+	record(InteractionTag | (uint8_t)interaction.state, (uint8_t)interaction.key, timestamp);
+}
+
+void Recorder::clear()
+{
+	_length = 0;
+	_isStarted = false;
+	_isFull = false;
+}
+
+const uint8_t* Recorder::getData() const
+{
+	return _buffer;
+}
+
+uint16_t Recorder::getLength() const
+{
+	return _length;
+}
+
+bool Recorder::isFull() const
+{
+	return _isFull;
+}
+
+#pragma endregion
+
+#pragma region Replayer
+
+Replayer::Replayer(const uint8_t* log, uint16_t length) : _log(log), _length(length)
+{
+}
+
+uint8_t Replayer::indexOf(KeyCode key)
+{
+	switch (key)
+	{
+	case KeyCode::Enter:
+		return 0;
+	case KeyCode::Escape:
+		return 1;
+	case KeyCode::LeftArrow:
+		return 2;
+	case KeyCode::UpArrow:
+		return 3;
+	case KeyCode::RightArrow:
+		return 4;
+	case KeyCode::DownArrow:
+		return 5;
+	default:
+		return KeyCount;
+	}
+}
+
+bool Replayer::read(uint8_t& out)
+{
+	if (_position >= _length)
+		return false;
+	out = _log[_position++];
+	return true;
+}
+
+void Replayer::resolve(bool changed)
+{
+	for (uint8_t i = 0; i < _pendingCount; i++)
+	{
+		auto index = indexOf(_pending[i].key);
+		if (!changed)
+			_unchanged++;
+		else if (index < KeyCount)
+			_latency[index].record(_clock.micros() - _pending[i].timestamp);
+	}
+	_pendingCount = 0;
+}
+
+bool Replayer::step(UIContext& context)
+{
+	uint8_t tag, key = 0, byte;
+	if (!read(tag) || ((tag & Recorder::InteractionTag) && !read(key)))
+		return false;
+
+	// A 32-bit delta takes at most five bytes. A longer run means the log
+	// is corrupt, and replay stops there.
+	uint32_t delta = 0;
+	for (uint8_t shift = 0; ; shift += 7)
+	{
+		if (shift > 28 || !read(byte))
+			return false;
+		delta |= uint32_t(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			break;
+	}
+	_clock.advance(delta);
+
+	if (tag == Recorder::FrameTag)
+	{
+		// Keys resolve at the first frame that changes the glass. A frame that
+		// completes without changing anything means the keys had no effect.
+		auto completed = context.update();
+		auto revision = context.getPrinter()->getRevision();
+		if (revision != _revision)
+			resolve(true);
+		else if (completed)
+			resolve(false);
+		_revision = revision;
+	}
+	else
+	{
+		// Only presses wait for a reaction. Releases rarely change anything
+		// and would be counted as keys without effect.
+		auto interaction = Interaction((KeyCode)key, (KeyState)(tag & ~Recorder::InteractionTag));
+		if (interaction.state != KeyState::Up)
+		{
+			if (_pendingCount < MaxPending)
+				_pending[_pendingCount++] = Pending{ interaction.key, _clock.micros() };
+			else
+				_dropped++;
+		}
+		context.interact(interaction);
+	}
+	return true;
+}
+
+void Replayer::run(UIContext& context)
+{
+	rewind();
+	auto& clock = context.getClock();
+	context.setClock(_clock);
+	_revision = context.getPrinter()->getRevision();
+	while (step(context))
+		;
+	context.setClock(clock);
+}
+
+void Replayer::rewind()
+{
+	_position = 0;
+	_pendingCount = 0;
+	_unchanged = 0;
+	_dropped = 0;
+	_clock.set(0);
+	for (auto& latency : _latency)
+		latency.reset();
+}
+
+const ManualClock& Replayer::getClock() const
+{
+	return _clock;
+}
+
+const Histogram& Replayer::getLatency(KeyCode key) const
+{
+	auto index = indexOf(key);
+	return _latency[index < KeyCount ? index : 0];
+}
+
+uint16_t Replayer::getUnchanged() const
+{
+	return _unchanged;
+}
+
+uint16_t Replayer::getDropped() const
+{
+	return _dropped;
+}
+
+#pragma endregion
@@ -0,0 +1,77 @@
+#pragma once
+
+class Recorder;
+class Replayer;
+
+#include "Arduino.h"
+#include "Crystalline.h"
+
+// Records are a tag byte followed by the microseconds since the previous
+// record as a 7-bit varint. Interactions carry the key code in an extra byte.
+class Recorder
+{
+private:
+	uint8_t* _buffer;
+	const uint16_t _capacity;
+	uint16_t _length = 0;
+	uint32_t _last = 0;
+	bool _isStarted = false;
+	bool _isFull = false;
+
+	void record(uint8_t tag, int16_t key, uint32_t timestamp);
+
+public:
+	static const uint8_t FrameTag = 0x00;
+	static const uint8_t InteractionTag = 0x40;
+
+	Recorder(uint8_t* buffer, uint16_t capacity);
+
+	void frame(uint32_t timestamp);
+	void interaction(const Interaction& interaction, uint32_t timestamp);
+	void clear();
+
+	const uint8_t* getData() const;
+	uint16_t getLength() const;
+	bool isFull() const;
+};
+
+class Replayer
+{
+private:
+	static const uint8_t KeyCount = 6;
+	static const uint8_t MaxPending = 8;
+
+	struct Pending
+	{
+		KeyCode key;
+		uint32_t timestamp;
+	};
+
+	const uint8_t* _log;
+	const uint16_t _length;
+	uint16_t _position = 0;
+	uint32_t _revision = 0;
+	ManualClock _clock;
+	Pending _pending[MaxPending];
+	uint8_t _pendingCount = 0;
+	uint16_t _unchanged = 0;
+	uint16_t _dropped = 0;
+	Histogram _latency[KeyCount];
+
+	static uint8_t indexOf(KeyCode key);
+
+	bool read(uint8_t& out);
+	void resolve(bool changed);
+
+public:
+	Replayer(const uint8_t* log, uint16_t length);
+
+	bool step(UIContext& context);
+	void run(UIContext& context);
+	void rewind();
+
+	const ManualClock& getClock() const;
+	const Histogram& getLatency(KeyCode key) const;
+	uint16_t getUnchanged() const;
+	uint16_t getDropped() const;
+};
@@ -0,0 +1,165 @@
+#include "Search.h"
+
+#pragma region PrefixIndex
+
+char PrefixIndex::keyAt(uint8_t position, uint8_t depth) const
+{
+	auto caption = _caption(_order[position]);
+	return depth < caption.length ? tolower((unsigned char)caption[depth]) : '\0';
+}
+
+int PrefixIndex::compare(uint8_t a, uint8_t b) const
+{
+	auto left = _caption(a);
+	auto right = _caption(b);
+	for (uint8_t i = 0; i < left.length && i < right.length; i++)
+	{
+		int difference = tolower((unsigned char)left[i]) - tolower((unsigned char)right[i]);
+		if (difference != 0)
+			return difference;
+	}
+	return left.length - right.length;
+}
+
+// Entries in the current range share their first _depth characters, so they
+// are sorted by the character that follows.
+uint8_t PrefixIndex::bound(char c, bool upper) const
+{
+	auto low = _start;
+	auto high = _end;
+	while (low < high)
+	{
+		uint8_t middle = low + (high - low) / 2;
+		auto key = keyAt(middle, _depth);
+		if (key < c || (upper && key == c))
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+void PrefixIndex::siftDown(uint8_t root, uint8_t length)
+{
+	for (uint16_t child = 2 * root + 1; child < length; root = child, child = 2 * root + 1)
+	{
+		if (child + 1 < length && compare(_order[child], _order[child + 1]) < 0)
+			child++;
+		if (compare(_order[root], _order[child]) >= 0)
+			return;
+		auto swap = _order[root];
+		_order[root] = _order[child];
+		_order[child] = swap;
+	}
+}
+
+// Heapsort: O(n log n) caption reads, in place and without recursion.
+void PrefixIndex::sort()
+{
+	uint8_t length = _order.length();
+	for (uint8_t i = length / 2; i-- > 0; )
+		siftDown(i, length);
+	while (length > 1)
+	{
+		length--;
+		auto swap = _order[0];
+		_order[0] = _order[length];
+		_order[length] = swap;
+		siftDown(0, length);
+	}
+}
+
+bool PrefixIndex::isSorted() const
+{
+	for (uint8_t i = 1; i < _order.length(); i++)
+		if (compare(_order[i - 1], _order[i]) > 0)
+			return false;
+	return true;
+}
+
+// Captions are read through the source rather than copied, so they must
+// stay put until the index is built again.
+void PrefixIndex::build(uint8_t count, CaptionSource caption)
+{
+	_caption = caption;
+	_order = count > 0 ? Array<uint8_t>::ofSize(count, 0) : Array<uint8_t>();
+	for (uint8_t i = 0; i < count; i++)
+		_order[i] = i;
+	sort();
+	clear();
+}
+
+uint8_t PrefixIndex::getCount() const
+{
+	return _order.length();
+}
+
+uint8_t PrefixIndex::getDepth() const
+{
+	return _depth;
+}
+
+int16_t PrefixIndex::getMatch() const
+{
+	return _depth > 0 ? _order[_start] : -1;
+}
+
+// The heap keeps a size header in front of every block, and a freed block
+// must be able to hold the free list link, as with avr-libc's malloc.
+static size_t heapSize(size_t bytes)
+{
+	return sizeof(size_t) + max(bytes, sizeof(void*));
+}
+
+size_t PrefixIndex::getFootprint() const
+{
+	// Built orders also own the array's reference counter.
+	if (_order.length() == 0)
+		return sizeof(PrefixIndex);
+	return sizeof(PrefixIndex) + heapSize(_order.length() * sizeof(uint8_t)) + heapSize(sizeof(int));
+}
+
+void PrefixIndex::clear()
+{
+	_start = 0;
+	_end = _order.length();
+	_depth = 0;
+}
+
+bool PrefixIndex::narrow(char c)
+{
+	// Captions may have changed since the last search. The order is only
+	// stale if it is no longer sorted, which one pass finds out.
+	if (_depth == 0 && !isSorted())
+		sort();
+
+	c = tolower((unsigned char)c);
+	auto start = bound(c, false);
+	auto end = bound(c, true);
+	if (start == end)
+		return false;
+	_start = start;
+	_end = end;
+	_depth++;
+	return true;
+}
+
+int16_t PrefixIndex::type(char c, uint32_t now)
+{
+	if (_depth > 0 && now - _typed > timeout)
+		clear();
+	_typed = now;
+
+	// A character that matches nothing starts a new search of its own.
+	if (!narrow(c))
+	{
+		if (_depth == 0)
+			return -1;
+		clear();
+		if (!narrow(c))
+			return -1;
+	}
+	return getMatch();
+}
+
+#pragma endregion
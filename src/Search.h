@@ -0,0 +1,54 @@
+#pragma once
+
+class PrefixIndex;
+
+#include "Arduino.h"
+#include "Array.h"
+#include "Delegate.h"
+#include "TextSpan.h"
+
+using CaptionSource = InlineDelegate<TextSpan, uint8_t>;
+
+// Letters, digits and spaces start or extend a search. Other printable
+// characters share their codes with the arrow keys.
+inline bool isSearchKey(int c)
+{
+	return c >= 0 && c < 128 && (isalnum(c) || c == ' ');
+}
+
+// Keeps item indices sorted by caption, ignoring case. Each typed
+// character narrows the range of entries that start with the text typed so
+// far using two binary searches, so a jump costs O(log n) caption reads.
+// Every new search first checks in one pass that the order still holds and
+// sorts again if a caption has changed.
+class PrefixIndex
+{
+private:
+	Array<uint8_t> _order;
+	CaptionSource _caption;
+	uint8_t _start = 0;
+	uint8_t _end = 0;
+	uint8_t _depth = 0;
+	uint32_t _typed = 0;
+
+	char keyAt(uint8_t position, uint8_t depth) const;
+	int compare(uint8_t a, uint8_t b) const;
+	uint8_t bound(char c, bool upper) const;
+	void siftDown(uint8_t root, uint8_t length);
+	void sort();
+	bool isSorted() const;
+
+public:
+	// A pause longer than this, in milliseconds, starts a new search.
+	uint16_t timeout = 1000;
+
+	void build(uint8_t count, CaptionSource caption);
+	uint8_t getCount() const;
+	uint8_t getDepth() const;
+	int16_t getMatch() const;
+	size_t getFootprint() const;
+
+	void clear();
+	bool narrow(char c);
+	int16_t type(char c, uint32_t now);
+};
@@ -0,0 +1,240 @@
+#include "Tables.h"
+
+#pragma region TableRow
+
+static TextSpan flashText(const char* s)
+{
+	return TextSpan(reinterpret_cast<const __FlashStringHelper*>(s));
+}
+
+void TableRow::onUpdate()
+{
+	if (_row.getter != nullptr)
+		DataControl<int32_t>::onUpdate();
+}
+
+void TableRow::onDraw(DrawContext& context)
+{
+	Control::onDraw(context);
+	if (_row.kind == RowKind::Button)
+	{
+		FocusToken* token;
+		bool isPressed = requestToken(token) && token->state == FocusState::Pressed;
+		context.write(isPressed ? '(' : '[');
+		context.write(flashText(_row.header));
+		context.write(isPressed ? ')' : ']');
+		context.fill();
+		return;
+	}
+
+	auto header = flashText(_row.header);
+	if (!context.omit(header.length, isDirty(UIFlag::FocusChanged)))
+		context.write(header);
+	onDrawContent(context);
+}
+
+void TableRow::onDrawContent(DrawContext& context)
+{
+	if (!isDirty(UIFlag::PropertyChanged | UIFlag::FocusChanged))
+		return;
+
+	switch (_row.kind)
+	{
+	case RowKind::Number:
+	{
+		char buffer[NumberFormat::Capacity];
+		auto length = NumberFormatter::format(buffer, _lastValue, NumberFormat());
+		auto suffix = flashText(_row.suffix);
+		auto spacing = suffix.length > 0 ? suffix.length + 1 : 0;
+		context.write(TextSpan(buffer, length), Alignment::Back, context.getRemaining() - spacing, Glyphs::LinePadding);
+		if (!context.omit(spacing, isDirty(UIFlag::FocusChanged)) && spacing > 0)
+		{
+			context.write(' ');
+			context.write(suffix);
+		}
+		break;
+	}
+
+	case RowKind::Switch:
+		if (_lastValue >= 0 && _lastValue <= _row.maximum)
+			context.fill(flashText((const char*)pgm_read_ptr(_row.options + _lastValue)), Alignment::Back, Glyphs::LinePadding);
+		else
+			context.fill(Glyphs::LinePadding);
+		break;
+
+	case RowKind::Toggle:
+		context.fill(_lastValue ? Glyphs::DefaultOn : Glyphs::DefaultOff, Alignment::Back, Glyphs::LinePadding);
+		break;
+
+	default:
+		context.fill();
+		break;
+	}
+}
+
+void TableRow::onManipulate(int sign, KeyState state)
+{
+	switch (_row.kind)
+	{
+	case RowKind::Number:
+		if (state == KeyState::Down || state == KeyState::Pressed)
+		{
+			auto step = _row.step;
+			for (auto factor = getAcceleration(); factor >= 10 && step <= NumberTraits<int32_t>::maximum() / 10; factor /= 10)
+				step *= 10;
+			edit(NumberFormatter::step(getEditValue(), sign, step, _row.minimum, _row.maximum));
+		}
+		break;
+
+	case RowKind::Switch:
+		if (_row.maximum >= 0)
+			edit(SwitchControl::stepOption(getEditValue(), sign, state, getAcceleration(), _row.maximum, false, SwitchControl::DefaultPageSize));
+		break;
+
+	case RowKind::Toggle:
+		if (state == KeyState::Down)
+			edit(!getEditValue());
+		break;
+
+	case RowKind::Label:
+	case RowKind::Button:
+		break;
+	}
+}
+
+bool TableRow::onInteract(const Interaction& e)
+{
+	if (_row.kind != RowKind::Button)
+		return DataControl<int32_t>::onInteract(e);
+
+	FocusToken* token;
+	if (!requestToken(token))
+		return false;
+
+	switch (token->state)
+	{
+	case FocusState::Normal:
+		if (isInteractable() && e.equals(KeyCode::Enter, KeyState::Down))
+		{
+			invalidate(token->state, FocusState::Pressed, UIFlag::StateChanged);
+			return true;
+		}
+		break;
+
+	case FocusState::Pressed:
+		if (e.equals(KeyCode::Enter, KeyState::Up))
+		{
+			_row.action();
+			invalidate(token->state, FocusState::Normal, UIFlag::StateChanged);
+			return true;
+		}
+		break;
+	}
+
+	return false;
+}
+
+// An edit still pending belongs to the row being replaced. Committing it
+// here would write a value nobody confirmed, so it is dropped; leaving the
+// row commits it, through onFocusLost.
+void TableRow::bind(const RowDescriptor* row)
+{
+	revert();
+	memcpy_P(&_row, row, sizeof(RowDescriptor));
+	content = InlineProperty<int32_t>(_row.getter, _row.setter);
+	invalidate(UIFlag::GlobalDraw);
+	onUpdate();
+}
+
+bool TableRow::isInteractable() const
+{
+	switch (_row.kind)
+	{
+	case RowKind::Label:
+		return false;
+
+	case RowKind::Button:
+		return isEnabled && _row.action != nullptr;
+
+	default:
+		return DataControl<int32_t>::isInteractable();
+	}
+}
+
+TextSpan TableRow::getCaption() const
+{
+	return flashText(_row.header);
+}
+
+#pragma endregion
+
+#pragma region TablePanel
+
+uint16_t TablePanel::getCountCore() const
+{
+	return _count;
+}
+
+void TablePanel::bindCore(Control& control, uint16_t index) const
+{
+	static_cast<TableRow&>(control).bind(&_rows[index]);
+}
+
+void TablePanel::onDrawHeader(DrawContext& context)
+{
+	if (isFocused())
+		context.fill(Glyphs::PointerDownLeft, flashText(_header), Glyphs::PointerDownRight, Alignment::Center);
+	else
+		context.fill(Glyphs::PointerOverLeft, flashText(_header), Glyphs::PointerOverRight, Alignment::Center);
+}
+
+TablePanel::TablePanel()
+{
+	for (int i = 0; i < CRYSTALLINE_MAX_ROWS; i++)
+		adopt(_controls[i] = &_rowPool[i]);
+	pool = arrayView(_controls);
+}
+
+void TablePanel::bind(const PanelDescriptor* panel)
+{
+	PanelDescriptor descriptor;
+	memcpy_P(&descriptor, panel, sizeof(PanelDescriptor));
+	_header = descriptor.header;
+	_rows = descriptor.rows;
+	_count = descriptor.count;
+	refresh();
+}
+
+TextSpan TablePanel::getCaption() const
+{
+	return flashText(_header);
+}
+
+#pragma endregion
+
+#pragma region TableMenu
+
+uint8_t TableMenu::getCountCore() const
+{
+	return _count;
+}
+
+MenuPanel* TableMenu::getPanelCore(int8_t index) const
+{
+	// Every panel is shown through the same instance, rebound on selection.
+	return &_panel;
+}
+
+void TableMenu::selectCore(int8_t index)
+{
+	if (index >= 0 && index < _count)
+		_panel.bind(&_panels[index]);
+}
+
+TableMenu::TableMenu(const PanelDescriptor* panels, uint8_t count) : _panels(panels), _count(count)
+{
+	adopt(&_panel);
+	selectCore(0);
+}
+
+#pragma endregion
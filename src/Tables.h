@@ -0,0 +1,146 @@
+#pragma once
+
+struct RowDescriptor;
+struct PanelDescriptor;
+class TableRow;
+class TablePanel;
+class TableMenu;
+
+#include "Arduino.h"
+#include "Controls.h"
+#include "Panels.h"
+#include "Crystalline.h"
+
+enum class RowKind : uint8_t
+{
+	Label,
+	Number,
+	Switch,
+	Toggle,
+	Button,
+};
+
+// Read-only row description, meant to be declared PROGMEM. All strings,
+// including the option table and its entries, must be in flash too.
+struct RowDescriptor
+{
+	RowKind kind;
+	const char* header;
+	const char* suffix;
+	const char* const* options;
+	int32_t minimum;
+	int32_t maximum;
+	int32_t step;
+	int32_t (*getter)();
+	void (*setter)(int32_t);
+	void (*action)();
+};
+
+struct PanelDescriptor
+{
+	const char* header;
+	const RowDescriptor* rows;
+	uint16_t count;
+};
+
+constexpr RowDescriptor labelRow(const char* header)
+{
+	return RowDescriptor{ RowKind::Label, header, nullptr, nullptr, 0, 0, 0, nullptr, nullptr, nullptr };
+}
+
+constexpr RowDescriptor numberRow(const char* header, int32_t (*getter)(), void (*setter)(int32_t) = nullptr,
+	int32_t minimum = -2147483647 - 1, int32_t maximum = 2147483647, int32_t step = 1, const char* suffix = nullptr)
+{
+	return RowDescriptor{ RowKind::Number, header, suffix, nullptr, minimum, maximum, step, getter, setter, nullptr };
+}
+
+constexpr RowDescriptor switchRow(const char* header, const char* const* options, uint8_t count, int32_t (*getter)(), void (*setter)(int32_t) = nullptr)
+{
+	return RowDescriptor{ RowKind::Switch, header, nullptr, options, 0, int32_t(count) - 1, 1, getter, setter, nullptr };
+}
+
+template<size_t N>
+constexpr RowDescriptor switchRow(const char* header, const char* const (&options)[N], int32_t (*getter)(), void (*setter)(int32_t) = nullptr)
+{
+	return switchRow(header, options, N, getter, setter);
+}
+
+constexpr RowDescriptor toggleRow(const char* header, int32_t (*getter)(), void (*setter)(int32_t) = nullptr)
+{
+	return RowDescriptor{ RowKind::Toggle, header, nullptr, nullptr, 0, 1, 1, getter, setter, nullptr };
+}
+
+constexpr RowDescriptor buttonRow(const char* header, void (*action)())
+{
+	return RowDescriptor{ RowKind::Button, header, nullptr, nullptr, 0, 0, 0, nullptr, nullptr, action };
+}
+
+template<size_t N>
+constexpr PanelDescriptor panelOf(const char* header, const RowDescriptor (&rows)[N])
+{
+	return PanelDescriptor{ header, rows, N };
+}
+
+// A pooled control that renders whichever flash row it is bound to.
+class TableRow : public DataControl<int32_t>
+{
+private:
+	RowDescriptor _row = RowDescriptor();
+
+protected:
+	void onUpdate() override;
+	void onDraw(DrawContext& context) override;
+	void onDrawContent(DrawContext& context) override;
+	void onManipulate(int sign, KeyState state) override;
+	bool onInteract(const Interaction& e) override;
+
+public:
+	void bind(const RowDescriptor* row);
+
+	bool isInteractable() const override;
+	TextSpan getCaption() const override;
+};
+
+// Shows a flash panel through a pool of rows that are rebound as they
+// scroll, like any other VirtualPanel.
+class TablePanel : public VirtualPanel
+{
+private:
+	const char* _header = nullptr;
+	const RowDescriptor* _rows = nullptr;
+	uint16_t _count = 0;
+	TableRow _rowPool[CRYSTALLINE_MAX_ROWS];
+	Control* _controls[CRYSTALLINE_MAX_ROWS];
+
+protected:
+	uint16_t getCountCore() const override;
+	void bindCore(Control& control, uint16_t index) const override;
+	void onDrawHeader(DrawContext& context) override;
+
+public:
+	TablePanel();
+
+	void bind(const PanelDescriptor* panel);
+
+	TextSpan getCaption() const override;
+};
+
+class TableMenu : public PagedLayout
+{
+private:
+	const PanelDescriptor* _panels;
+	uint8_t _count;
+	// Handed out by the const getPanelCore().
+	mutable TablePanel _panel;
+
+protected:
+	uint8_t getCountCore() const override;
+	MenuPanel* getPanelCore(int8_t index) const override;
+	void selectCore(int8_t index) override;
+
+public:
+	TableMenu(const PanelDescriptor* panels, uint8_t count);
+
+	template<size_t N>
+	TableMenu(const PanelDescriptor (&panels)[N]) : TableMenu(panels, N) { }
+};
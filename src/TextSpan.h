@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Arduino.h"
+
+// Text longer than 255 characters, more than any display row holds, is cut
+// short to fit the length field.
+struct TextSpan
+{
+	const char* data;
+	uint8_t length;
+	bool isFlash;
+
+	static uint8_t clampLength(size_t length) { return length < 255 ? length : 255; }
+
+	TextSpan() : data(nullptr), length(0), isFlash(false) { }
+	TextSpan(const char* s) : data(s), length(s != nullptr ? clampLength(strlen(s)) : 0), isFlash(false) { }
+	TextSpan(const char* s, uint8_t length, bool isFlash = false) : data(s), length(length), isFlash(isFlash) { }
+	TextSpan(const __FlashStringHelper* s) : data(reinterpret_cast<const char*>(s)), length(s != nullptr ? clampLength(strlen_P(data)) : 0), isFlash(true) { }
+	TextSpan(const String& s) : data(s.c_str()), length(clampLength(s.length())), isFlash(false) { }
+
+	char operator[](uint8_t index) const { return isFlash ? (char)pgm_read_byte(data + index) : data[index]; }
+};
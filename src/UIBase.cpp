@@ -2,6 +2,21 @@
 
 #pragma region UIElement
 
+UIContext& UIElement::getContext() const
+{
+    return _context != nullptr ? *_context : Crystalline::getDefault();
+}
+
+UIElement* UIElement::adopt(UIElement* child)
+{
+    if (child == nullptr)
+        return nullptr;
+    child->_parent = this;
+    if (_context != nullptr)
+        child->_context = _context;
+    return child;
+}
+
 bool UIElement::isDirty(UIFlag flag) const
 {
     return (_flags & (flag | UIFlag::GlobalDraw)) > UIFlag::None;
@@ -9,7 +24,7 @@ bool UIElement::isDirty(UIFlag flag) const
 
 bool UIElement::isFocused() const
 {
-    return Crystalline::isFocused(*this);
+    return getContext().isFocused(*this);
 }
 
 UIFlag UIElement::getFlags() const
@@ -17,16 +32,28 @@ UIFlag UIElement::getFlags() const
     return _flags;
 }
 
+UIElement* UIElement::getParent() const
+{
+    return _parent;
+}
+
 void UIElement::invalidate(UIFlag flag)
 {
     _flags |= flag;
+    if (_rows != 0)
+        getContext().invalidateRows(_rows);
+
+    // A marked ancestor may sit below one that was drawn and cleared since,
+    // so the whole chain is marked every time.
+    for (auto* parent = _parent; parent != nullptr; parent = parent->_parent)
+        parent->_flags |= UIFlag::ChildDirty;
 }
 
 
 void UIElement::reset()
 {
     invalidate(UIFlag::LocalReset);
-    auto* source = focusSource();
+    auto* source = adopt(focusSource());
     if (source != nullptr)
         source->reset();
     onReset();
@@ -34,12 +61,13 @@ void UIElement::reset()
 
 void UIElement::update()
 {
+    CRYSTALLINE_PROFILE(getContext().getCurrentFrame().updated++);
     onUpdate();
 }
 
 bool UIElement::interact(const Interaction& interaction)
 {
-    auto* source = focusSource();
+    auto* source = adopt(focusSource());
     if (source != nullptr && source->interact(interaction))
         return true;
     return onInteract(interaction);
@@ -47,7 +75,7 @@ bool UIElement::interact(const Interaction& interaction)
 
 UIElement* UIElement::resolveFocus()
 {
-    auto* source = focusSource();
+    auto* source = adopt(focusSource());
     if (source == nullptr)
         return this;
     return source->resolveFocus();
@@ -55,7 +83,7 @@ UIElement* UIElement::resolveFocus()
 
 bool UIElement::requestToken(FocusToken*& out) const
 {
-    return Crystalline::requestToken(*this, out);
+    return getContext().requestToken(*this, out);
 }
 
 #pragma endregion
@@ -65,33 +93,30 @@ bool UIElement::requestToken(FocusToken*& out) const
 
 bool UILayout::handleUpdate(UILayout* layout)
 {
-    if (layout == nullptr)
+    if (adopt(layout) == nullptr)
         return false;
     layout->update();
-    if (layout->isDirty())
-        invalidate(UIFlag::LayoutChanged);
     return true;
 }
 
 bool UILayout::handleDraw(UILayout* layout, Range rows)
 {
-    if (layout == nullptr)
+    if (adopt(layout) == nullptr)
         return false;
-    if (isDirty(UIFlag::LayoutChanged))
-        layout->draw(rows, isDirty(UIFlag::GlobalDraw));
+    layout->draw(rows, isDirty(UIFlag::GlobalDraw));
     return true;
 }
 
 void UILayout::handleFocus(bool redraw, bool reset)
 {
-    auto* focus = focusSource();
+    auto* focus = adopt(focusSource());
     if (focus == nullptr)
         focus = this;
     if (redraw)
         focus->invalidate(UIFlag::GlobalDraw);
     if (reset)
         focus->reset();
-    Crystalline::invalidateFocus();
+    getContext().invalidateFocus();
 }
 
 void UILayout::draw(Range rows, bool redraw)
@@ -99,11 +124,16 @@ void UILayout::draw(Range rows, bool redraw)
     if (rows.length() <= 0)
         return;
 
+    _rows = rows.mask();
     if (redraw)
         invalidate(UIFlag::GlobalDraw);
 
-    if (isDirty())
+    // Dirty descendants mark their ancestors with ChildDirty, and content
+    // marks its rows, so clean subtrees are pruned here without being
+    // visited.
+    if (isDirty() || getContext().hasDirtyRows(_rows))
     {
+        CRYSTALLINE_PROFILE(getContext().getCurrentFrame().drawn++);
         onValidate();
         onDraw(rows);
         _flags = UIFlag::None;
@@ -120,6 +150,7 @@ void UIContent::draw(DrawContext& context, bool redraw)
         invalidate(UIFlag::GlobalDraw);
     if (isDirty())
     {
+        CRYSTALLINE_PROFILE(getContext().getCurrentFrame().drawn++);
         onValidate();
         onDraw(context);
         _flags = UIFlag::None;